@@ -0,0 +1,84 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>  // for the history files
+#include <sstream>  // for parsing the lines of the history
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>   // for std::unique_ptr, the models must not move
+#include <mutex>    // the models are shared between the curves that run at the same time
+#include <algorithm> // for std::stable_sort
+#include <numeric>  // for std::iota
+#include <cmath>    // for std::log, std::exp
+#include <cstdio>   // for std::snprintf, std::rename, the rounding of the features and the history file
+#include <cstdlib>  // for std::strtod
+
+namespace FBS {
+
+/* CostModel
+ * predicts the wall time of the evaluation of a star from a few of its parameters (the features, e.g. log rho_0, beta, phi_0),
+ *  so that the drivers in mr_curves can start the most expensive stars first and don't wait for a slow star at the end
+ *
+ * The model is off by default (see enabled). When it is on, the model learns from the measured times of earlier evaluations:
+ *  every driver records the features and the measured time of its stars, which are kept as one running mean of ln(time) per grid point,
+ *  i.e. per distinct set of features (rounded to 8 significant digits). The grid points are written to a history file per model
+ *  (see history_file), which is read on the next run. The history is therefore bounded by the number of grid points.
+ * The name of the model has to tell apart everything else that changes the cost, e.g. the EoS, mu and lambda (see mr_curves.cpp).
+ * The prediction is the mean of the grid point of the star if it was seen before, otherwise the geometric mean of the nearest
+ *  grid points, where the distance is measured with the features scaled to their range. Without grid points the prediction is 0
+ *  and the stars keep their order */
+class CostModel {
+public:
+    /* The running mean of a grid point */
+    struct GridPoint {
+        double mean_log_seconds;    // the running mean of ln of the measured wall time
+        unsigned int count;         // the number of measurements, up to max_count
+    };
+
+    /* The model with the name, e.g. "NSEinsteinCartan_<key of the EoS>", with the names of its features (used in the history file).
+     * It is created and loaded from the history file on first use */
+    static CostModel& instance(const std::string& name, const std::vector<std::string>& feature_names);
+
+    /* Whether the drivers use the cost models, off by default. Without them the stars are evaluated in their order
+     *  and no history is read or written */
+    static bool enabled;
+    /* The directory of the history files, "output/" by default. The files are not written if it doesn't exist */
+    static std::string history_directory;
+    /* The number of nearest grid points that are averaged for a star at a new grid point */
+    static unsigned int neighbours;
+    /* The running mean of a grid point weighs the newest measurement with at least 1/max_count, so it follows changes of the code */
+    static unsigned int max_count;
+
+    /* the history file of the model */
+    std::string history_file() const;
+
+    /* The predicted wall time in s */
+    double predict(const std::vector<double>& features) const;
+    /* The indices of the stars by decreasing predicted time, stars with the same prediction keep their order */
+    std::vector<std::size_t> longest_first(const std::vector<std::vector<double>>& features, std::vector<double>& predictions) const;
+
+    /* Adds a measurement to the running mean of its grid point */
+    void record(const std::vector<double>& features, const double seconds);
+    /* Writes all grid points to the history file if there were new measurements, returns false if it can't be written */
+    bool save();
+
+    std::string name;
+    std::vector<std::string> feature_names;
+
+protected:
+    std::map<std::vector<double>, GridPoint> points;    // by the rounded features
+    std::vector<double> min_features, max_features;     // the range of the grid points
+    unsigned int new_measurements;     // since the last save
+    mutable std::mutex mutex;
+
+    CostModel(const std::string& name, const std::vector<std::string>& feature_names);
+    /* reads the grid points of the history file */
+    void load();
+    /* adds a measurement with the rounded features to its grid point and updates the range of the features, the mutex has to be held */
+    void add(const std::vector<double>& key, const double log_seconds, const unsigned int count);
+    /* the prediction for the features, the mutex has to be held */
+    double predict_locked(const std::vector<double>& features) const;
+};
+
+}
@@ -3,14 +3,28 @@
 #include <vector>
 #include <cmath>
 #include <fstream>	// filestream for file input
-#include <sstream>	// string stream used for reading the EOS table
+#include <sstream>	// string stream
 #include <iostream>
 #include <stdexcept> // for std::runtime_error
 #include <map>
+#include <utility>  // for std::forward
+#include <algorithm> // for std::upper_bound
+#include <cstdint>   // for std::uint64_t
+#include <cstring>   // for std::memcpy
+#include <string>
 
 
 namespace FBS{
 
+/* EoSQuantities
+ *  the quantities of an equation of state at a given pressure, see EquationOfState::query */
+struct EoSQuantities {
+    double e;           // total energy density
+    double rho;         // restmass density
+    double epsilon;     // specific internal energy, e = rho*(1+epsilon)
+    double dP_de, dP_drho;
+};
+
 /* Equation of State
  *  an abstract class to model what an equation of state should contain
  *
@@ -38,6 +52,30 @@ public:
     virtual double min_rho() = 0;	// minimal value of restmass density
 	virtual double min_e() = 0;	// minimal value of total energy density e:=rho(1+epsilon)
 
+    /* This gives all quantities at the pressure P in one call, so that a tabulated EoS is searched only once.
+     * The values are those of get_e_from_P(P), get_rho_from_P(P), dP_de(e) and dP_drho(rho, epsilon) */
+    virtual EoSQuantities query(const double P)
+    {
+        EoSQuantities q;
+        q.e = this->get_e_from_P(P);
+        q.rho = this->get_rho_from_P(P);
+        q.epsilon = q.rho > 0. ? q.e/q.rho - 1. : 0.;
+        q.dP_de = this->dP_de(q.e);
+        q.dP_drho = this->dP_drho(q.rho, q.epsilon);
+        return q;
+    }
+
+    /* Batch versions of get_e_from_P, get_rho_from_P and callEOS for the n pressures P[0..n-1], e.g. the steps of a trajectory.
+     * The outputs have to hold n values. The defaults call the functions above for every point,
+     *  the tabulated and polytropic EoS override them with loops without virtual calls */
+    virtual void e_from_P_batch(const double* P, double* e, const std::size_t n);
+    virtual void rho_from_P_batch(const double* P, double* rho, const std::size_t n);
+    virtual void callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n);
+    /* The same as e_from_P_batch for points that each belong to an integration of their own, e.g. the lanes of integrator::lockstep_DoPri5.
+     * hints[k] is the interval of the last lookup of point k, which a tabulated EoS tries first and updates (start with 1).
+     * The default ignores the hints */
+    virtual void e_from_P_lanes(const double* P, double* e, std::size_t* hints, const std::size_t n)
+    {  this->e_from_P_batch(P, e, n);  }
 };
 
 /* PolytropicEoS
@@ -46,7 +84,7 @@ public:
  * such that
  *  P = Kappa * rho^{Gamma}
  * */
-class PolytropicEoS : public EquationOfState
+class PolytropicEoS final : public EquationOfState
 {
 protected:
     double kappa, Gamma;
@@ -58,19 +96,84 @@ public:
     double get_P_from_rho(const double rho_in, const double epsilon);
 	double get_P_from_e(const double etot_in);
 	double get_e_from_P(const double P_in);
+	double get_rho_from_P(const double P_in);
 
 	double dP_drho(const double rho, double epsilon);
 
-    /* This gives the derivative dP/de depending on the matter density rho. The internal energy density is ignored */
+    /* This gives the derivative dP/de = Gamma*P/(e+P). P(e) has no closed form and is found by Newton's method */
     double dP_de(const double e);
     /* This gives the matter density rho and internal energy density depending on the pressure P */
 	void callEOS(double& myrho, double& epsilon, const double P);
+    /* All quantities in closed form from P */
+    EoSQuantities query(const double P);
+
+    void e_from_P_batch(const double* P, double* e, const std::size_t n);
+    void rho_from_P_batch(const double* P, double* rho, const std::size_t n);
+    void callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n);
 
     /* Functions giving minimal P and minimal rho. For the polytrope both are 0. */
-    double min_P();
-    double min_rho();
-	double min_e();
+    double min_P() { return 0.; }
+    double min_rho() { return 0.; }
+	double min_e() { return 0.; }
+
+};
+
+/* PiecewisePolytropeEoS
+ * the piecewise polytrope of Read, Lackey, Owen and Friedman, Phys. Rev. D 79, 124032 (2009)
+ * with the four parameters
+ *  log_p1: log10 of the pressure in dyn/cm^2 at the restmass density rho_1 = 10^14.7 g/cm^3
+ *  Gamma1, Gamma2, Gamma3: the adiabatic indices of the core between rho_0, rho_1, rho_2 = 10^15 g/cm^3 and above
+ * The crust is the fit of Read et al. to SLy with four polytropes, the core begins where its first polytrope meets the last one of the crust.
+ * The defaults are the fit to SLy.
+ *
+ * In every piece i with rho_i <= rho < rho_{i+1}
+ *  P = K_i rho^Gamma_i,  e = (1 + a_i) rho + K_i/(Gamma_i - 1) rho^Gamma_i
+ * where a_i makes e continuous. So rho, e and dP/de = Gamma_i P/(e + P) are closed-form in P,
+ *  only get_P_from_e and dP_de(e) have to find rho from e with Newton's method
+ * */
+class PiecewisePolytropeEoS final : public EquationOfState
+{
+public:
+    struct Piece {
+        double rho, P, e;           // at the lower boundary
+        double K, Gamma, a;
+    };
+
+protected:
+    double log_p1, Gamma1, Gamma2, Gamma3;
+    std::vector<Piece> pieces;
+
+    /* The piece that contains P, or e */
+    const Piece& piece_from_P(const double P) const;
+    const Piece& piece_from_e(const double e) const;
+    /* The restmass density for the energy density e in the piece */
+    double rho_from_e(const Piece& piece, const double e) const;
+
+public:
+    PiecewisePolytropeEoS(const double log_p1=34.384, const double Gamma1=3.005, const double Gamma2=2.988, const double Gamma3=2.851);
+
+    double get_P_from_rho(const double rho_in, const double epsilon);
+	double get_P_from_e(const double etot_in);
+	double get_e_from_P(const double P_in);
+	double get_rho_from_P(const double P_in);
+
+	double dP_drho(const double rho, double epsilon);
+    double dP_de(const double e);
+    double dP_de(const double rho, double epsilon);
+
+	void callEOS(double& myrho, double& epsilon, const double P);
+    EoSQuantities query(const double P);
+
+    void e_from_P_batch(const double* P, double* e, const std::size_t n);
+    void rho_from_P_batch(const double* P, double* rho, const std::size_t n);
+    void callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n);
 
+    /* The pieces of the crust and the core in code units */
+    const std::vector<Piece>& get_pieces() const { return this->pieces; }
+
+    double min_P() { return 0.; }
+    double min_rho() { return 0.; }
+	double min_e() { return 0.; }
 };
 
 
@@ -80,7 +183,7 @@ public:
  * such that
  *  P = P_f + rho(1+eps) - eps_f
  * */
-class CausalEoS : public EquationOfState
+class CausalEoS final : public EquationOfState
 {
 protected:
     double eps_f, P_f;
@@ -91,24 +194,25 @@ public:
     /* This gives the pressure P depending on the matter density rho and internal energy epsilon */
     double get_P_from_rho(const double rho_in, const double epsilon);
 	double get_P_from_e(const double etot_in);
-	double get_e_from_P(const double P_in);
+	double get_e_from_P(const double P_in) { return P_in - this->P_f + this->eps_f; }  // p = P_f + eps - eps_f
+	double get_rho_from_P(const double P_in);
 
     /* This gives the derivative dP/de depending on the matter density rho and internal energy epsilon */
-    double dP_de(const double e);
+    double dP_de(const double e) { return 1.; }
 	double dP_drho(const double rho, double epsilon);
 
     /* This gives the matter density rho and internal energy epsilon depending on the pressure P */
 	void callEOS(double& myrho, double& epsilon, const double P);
 
     /* Functions giving minimal P and minimal rho. For the causal EoS both are 0. */
-    double min_P();
-    double min_rho();
-	double min_e();
+    double min_P() { return 0.; }
+    double min_rho() { return 0.; }
+	double min_e() { return 0.; }
 };
 
 
 /* a class modeling the effective equation of state for a bosonic condensate of self-interacting bosons */
-class EffectiveBosonicEoS : public EquationOfState
+class EffectiveBosonicEoS final : public EquationOfState
 {
 protected:
     double rho0;	// parameter computed from boson mass and self-interaction-parameter, corresponds to total energy density of the boson-fluid
@@ -122,6 +226,7 @@ public:
     double get_P_from_rho(const double rho_in, const double epsilon);
 	double get_P_from_e(const double etot_in);
 	double get_e_from_P(const double P_in);
+	double get_rho_from_P(const double P_in);
 	void callEOS(double& myrho, double& epsilon, const double P);
     double dP_drho(const double rho, double epsilon);
 	double dP_de(const double etot);
@@ -129,9 +234,46 @@ public:
 	double get_mu();
 	double get_lambda();
 
-    double min_P();
-    double min_rho();
-	double min_e();
+    double min_P() { return 0.; }
+    double min_rho() { return 0.; }
+	double min_e() { return 0.; }
+};
+
+
+/* EoSTableFormat
+ * describes the layout of a text file with an EoS table, see EoStable::load_from_file
+ *  columns: the columns in the order of the file, with the quantity they hold ("rho", "e" or "P", or "" if they are skipped)
+ *           and their unit. rho is the baryon number density, which is converted to a restmass density with the neutron mass
+ *  comment_markers: characters that start a comment, the rest of the line is ignored
+ *  monotonicity: what to do with rows where P doesn't increase
+ *              keep: P may stay constant, decreasing P is reported
+ *              drop: rows are dropped (and reported) unless rho, e and P are larger than in the last row that was kept
+ *              error: decreasing P throws
+ * Columns are separated by whitespace or commas, lines without values are skipped */
+struct EoSTableFormat {
+    enum Unit { code_units, MeV_fm3, per_fm3 };
+    enum Monotonicity { keep, drop, error };
+    struct Column {
+        std::string name;       // only used in messages
+        std::string quantity;
+        Unit unit;
+    };
+
+    std::string name;
+    std::vector<Column> columns;
+    std::string comment_markers;
+    Monotonicity monotonicity;
+
+    /* The tables in EOS_tables/ from CompOSE:  n_b [1/fm^3] | Y_e | e [MeV/fm^3] | P [MeV/fm^3] */
+    static EoSTableFormat compose();
+    /* The tables in EOS_tables/Jan-Erik-EOS/:  n_b [1/fm^3] | row number | P [MeV/fm^3] | e [MeV/fm^3]
+     * They have a step back in P where the crust is joined to the core and repeat their last row, these rows are dropped */
+    static EoSTableFormat jan_erik();
+    /* The layout given by the column indices of rho [1/fm^3], e and P [MeV/fm^3], with the other columns skipped */
+    static EoSTableFormat from_indices(const std::map<std::string, int>& indices);
+
+    /* A hash of everything that changes the parsed table, e.g. to check whether a cache was made with this format */
+    std::uint64_t fingerprint() const;
 };
 
 
@@ -140,42 +282,215 @@ public:
  * On construction, the tabulated EoS has to be loaded into the
  *  vectors rho, Pres, e_tot,   the mass density, Pressure, and energy density respectively
  * On call, the values are interpolated linearly from the table
+ *
+ * The table is stored as one node per row, which holds P, e, rho and dP/de at that row,
+ *  so that the two rows of an interval are close in memory. dP/drho is only needed by few models and is stored separately
+ * The derivatives are computed on loading from the slopes of the neighbouring intervals (see compute_derivatives)
+ * The interval is found by binary search. Optionally, the interval of the last lookup of the calling thread is tried first,
+ *  which is the right one in most cases, as the pressure changes monotonically during the integration of a star
+ *
+ * Optionally, the table can be resampled onto a grid that is uniform in log P (see resample_log_uniform),
+ *  then the intervals of P and rho are found by an index over cells uniform in log P and log rho instead of a search
  * */
-class EoStable : public EquationOfState
+class EoStable final : public EquationOfState
 {
+public:
+    /* 32 bytes, so that a node never straddles a cache line and the two nodes of an interval share one in half of the cases */
+    struct alignas(32) Node {
+        double P, e, rho;
+        double dP_de;
+    };
+
+    /* an index of the nodes by the quantity x: the range of log x is divided into cells of equal size,
+     *  every cell holds the first node above its lower boundary
+     * (log x is approximated piecewise linearly from the bits of x, see fast_log2 in eos.cpp) */
+    struct LogIndex {
+        double log_x0, inv_dlog_x;
+        std::vector<std::size_t> cells;
+    };
+
 protected:
-	std::vector<double> rho_table, P_table, e_table;
+	std::vector<Node> nodes;
+    std::vector<double> node_dP_drho;   // dP/drho at the nodes, apart from them as only dP_drho and query need it
+    LogIndex P_index, rho_index;    // only for resampled tables
+    bool resampled;
+    bool use_hint;  // whether the interval of the last lookup is tried before the binary search
+    bool frozen;    // see freeze
+
+    /* throws if the table is frozen */
+    void check_not_frozen(const std::string& change) const;
+
+    /* builds the nodes from the columns of the table */
+    void set_table(const std::vector<double>& rho_table, const std::vector<double>& P_table, const std::vector<double>& e_table);
+    /* gives the first index i >= 1 with nodes[i].*key > x, or nodes.size() if there is none,
+     *  such that x is in the interval [nodes[i-1].*key, nodes[i].*key) */
+    std::size_t upper_index(double Node::* key, const double x) const;
+    /* the same with the given hint instead of the one of the thread */
+    std::size_t upper_index(double Node::* key, const double x, std::size_t& hint) const;
+    /* the same by the cell of x in the index */
+    std::size_t upper_index(const LogIndex& index, double Node::* key, const double x) const;
+    /* builds the index of the nodes by the key with the given number of cells */
+    void build_index(LogIndex& index, double Node::* key, const std::size_t n_cells);
+    /* computes the derivatives at the nodes */
+    void compute_derivatives();
+    /* gives upper_index(&Node::P, P[k]) for the pressures above the first node and 0 for the others.
+     * The interval of the previous point is tried first, the hint of the thread is not used */
+    void P_intervals(const double* P, std::size_t* intervals, const std::size_t n) const;
 
 public:
     EoStable(const std::vector<double>& rho_table, const std::vector<double>& P_table, const std::vector<double>& e_table)
-        : rho_table(rho_table), P_table(P_table), e_table(e_table) {}
+        : resampled(false), use_hint(true), frozen(false) { this->set_table(rho_table, P_table, e_table); }
 
-    /* Constructor expects link to file */
-    EoStable(const std::string filename) : rho_table({}), P_table({}), e_table({})
+    /* A table from nodes, e.g. from the binary cache of the EoSRegistry, the derivatives are computed again */
+    EoStable(std::vector<Node> table_nodes) : nodes(std::move(table_nodes)), resampled(false), use_hint(true), frozen(false) { this->compute_derivatives(); }
+
+    /* Constructor expects link to file. If resample_points > 0, the table is resampled with resample_log_uniform */
+    EoStable(const std::string filename, const unsigned int resample_points=0) : resampled(false), use_hint(true), frozen(false)
         { if(! load_from_file(filename))
+                throw std::runtime_error("File '" + filename + "' could not be loaded") ;
+          if(resample_points > 0)
+                this->resample_log_uniform(resample_points);  }
+
+    /* Constructor for a file in the given format */
+    EoStable(const std::string filename, const EoSTableFormat& format) : resampled(false), use_hint(true), frozen(false)
+        { if(! load_from_file(filename, format))
                 throw std::runtime_error("File '" + filename + "' could not be loaded") ;  }
 
-    /* This function loads an EoS from file, the first one with rigid column indices, the second one with arbitrary indices*/
+    /* This function loads an EoS from file, the first one with rigid column indices, the second one with arbitrary indices,
+     *  the third one in the given format. They return false if the file can't be opened and throw if it can't be parsed */
     bool load_from_file(const std::string filename);
     bool load_from_file(const std::string filename, std::map<std::string, int> indices);
+    bool load_from_file(const std::string filename, const EoSTableFormat& format);
+
+    /* Resamples the table onto the given number of points uniform in log P, in addition to the rows of the table, and builds
+     *  the indices by log P and log rho, which have the same number of cells.
+     * Between the rows, e(P) is interpolated by a monotone cubic in log e - log P, and rho(P) follows the first law d(ln rho) = de/(e+P)
+     *  (scaled such that it matches the rows).
+     * The rows are kept, because the grid can't resolve the parts of the crust where P is nearly constant.
+     * The largest relative deviations from the linear interpolation of the original table are printed */
+    void resample_log_uniform(const unsigned int points);
+
+    /* Sets whether the interval of the last lookup is tried before the binary search (on by default) */
+    void set_use_hint(const bool hint);
+    bool uses_hint() const { return this->use_hint; }
+    /* Forbids all further changes of the table: load_from_file, resample_log_uniform and set_use_hint throw afterwards.
+     *  The EoSRegistry freezes its tables before it hands them out, as they are shared */
+    void freeze() { this->frozen = true; }
+    bool is_frozen() const { return this->frozen; }
 
     /* This gives the pressure P depending on the matter density rho and internal energy epsilon by linear interpolation of the table*/
 	void callEOS(double& myrho, double& epsilon, const double P);
+    /* The derivatives dP/drho and dP/de, which are interpolated linearly between the derivatives at the nodes */
     double dP_drho(const double rho, double epsilon);
 	double dP_de(const double e);
-    /* This gives the derivative dP/de depending on the matter density rho and internal energy epsilon by linear interpolation */
     /* This gives the matter density rho and internal energy epsilon depending on the pressure P by linear interpolation*/
     double get_P_from_rho(const double rho, const double epsilon);
 	double get_P_from_e(const double e);
 	double get_e_from_P(const double P);
 	double get_rho_from_P(const double P);
+    /* This finds the interval of P once and interpolates all quantities in it */
+    EoSQuantities query(const double P);
+    /* The sound speed c_s = sqrt(dP/de), from dP/de interpolated linearly in P */
+    double sound_speed(const double P);
+
+    /* The same values as get_e_from_P, get_rho_from_P and callEOS. The intervals are found first,
+     *  then the values are interpolated in a loop that the compiler can vectorize */
+    void e_from_P_batch(const double* P, double* e, const std::size_t n);
+    void rho_from_P_batch(const double* P, double* rho, const std::size_t n);
+    void callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n);
+    /* The same values as get_e_from_P, with the interval of every point tried first from its hint */
+    void e_from_P_lanes(const double* P, double* e, std::size_t* hints, const std::size_t n);
+
+    /* The nodes of the table in code units */
+    const std::vector<Node>& get_nodes() const { return this->nodes; }
 
     /* Functions giving minimal P and minimal rho. These depend on the lowest values in the tables */
-    double min_P();
-    double min_rho();
-	double min_e();
+    double min_P() { return this->nodes.at(0).P; }
+    double min_rho() { return this->nodes.at(0).rho; }
+	double min_e() { return this->nodes.at(0).e; }
 
 };
 
+/* The formulas of the analytic EoS that are called in the right hand sides of the models.
+ * They are defined here, so that they can be inlined when the type of the EoS is known */
+inline double PolytropicEoS::get_e_from_P(const double P_in) {
+	// etot = rho*(1+epsilon)
+	double myrho = std::pow(P_in / this->kappa, 1./this->Gamma);
+    double epsilon = this->kappa*std::pow(myrho, this->Gamma - 1.) / (this->Gamma - 1.);
+	return ( myrho*(1. + epsilon) );
+}
+
+inline EoSQuantities PolytropicEoS::query(const double P) {
+    EoSQuantities q;
+    q.rho = std::pow(P / this->kappa, 1./this->Gamma);
+    q.epsilon = q.rho > 0. ? P / (q.rho * (this->Gamma - 1.)) : 0.;
+    q.e = q.rho * (1. + q.epsilon);
+    q.dP_de = q.e + P > 0. ? this->Gamma * P / (q.e + P) : 0.;
+    q.dP_drho = q.rho > 0. ? this->Gamma * P / q.rho : 0.;
+    return q;
+}
+
+/* The pieces are few, so they are searched linearly from the top, where the core of a star is */
+inline const PiecewisePolytropeEoS::Piece& PiecewisePolytropeEoS::piece_from_P(const double P) const {
+    std::size_t i = pieces.size() - 1;
+    while(i > 0 && P < pieces[i].P)
+        i--;
+    return pieces[i];
+}
+
+inline double PiecewisePolytropeEoS::get_rho_from_P(const double P_in) {
+    const Piece& piece = this->piece_from_P(P_in);
+    return std::pow(P_in / piece.K, 1./piece.Gamma);
+}
+
+inline double PiecewisePolytropeEoS::get_e_from_P(const double P_in) {
+    const Piece& piece = this->piece_from_P(P_in);
+    const double rho = std::pow(P_in / piece.K, 1./piece.Gamma);
+    return (1. + piece.a) * rho + P_in / (piece.Gamma - 1.);
+}
+
+inline EoSQuantities PiecewisePolytropeEoS::query(const double P) {
+    const Piece& piece = this->piece_from_P(P);
+    EoSQuantities q;
+    q.rho = std::pow(P / piece.K, 1./piece.Gamma);
+    q.e = (1. + piece.a) * q.rho + P / (piece.Gamma - 1.);
+    q.epsilon = q.rho > 0. ? q.e / q.rho - 1. : piece.a;
+    q.dP_de = q.e + P > 0. ? piece.Gamma * P / (q.e + P) : 0.;
+    q.dP_drho = q.rho > 0. ? piece.Gamma * P / q.rho : 0.;
+    return q;
+}
+
+inline double EffectiveBosonicEoS::get_e_from_P(const double P_in) {
+	// etot is the total energy density of the fluid
+	return ( 3.*P_in + 4.* std::sqrt( P_in * this->rho0) );	// positive root taken fron rho= 3*P +/- 4* sqrt(P*rho0) );	// p = 4/9 * rho0 * ( sqrt(1 + 3/4 * rho/rho0) -1 )^2
+}
+
+inline double EffectiveBosonicEoS::dP_de(const double etot_in) {
+	// etot is actually the total energy density of the fluid
+	return ( 1./3. - std::pow(1.+ (3./4.)*(etot_in/this->rho0) , -0.5) / 3.0 );
+}
+
+/* dispatch_eos
+ * calls f with a reference to the EoS of its concrete type, e.g. f(EoStable&), or with EquationOfState& for other EoS
+ * The concrete classes above are final, so the calls that f makes to the EoS are not virtual and the simple ones are inlined.
+ * The models use this to instantiate their right hand side for the EoS once per integration,
+ *  instead of calling the EoS virtually in every evaluation.
+ * f has to return the same type for every EoS */
+template <typename F>
+auto dispatch_eos(EquationOfState& eos, F&& f) -> decltype(f(eos))
+{
+    if(EoStable* table = dynamic_cast<EoStable*>(&eos))
+        return std::forward<F>(f)(*table);
+    if(PolytropicEoS* polytrope = dynamic_cast<PolytropicEoS*>(&eos))
+        return std::forward<F>(f)(*polytrope);
+    if(PiecewisePolytropeEoS* piecewise = dynamic_cast<PiecewisePolytropeEoS*>(&eos))
+        return std::forward<F>(f)(*piecewise);
+    if(CausalEoS* causal = dynamic_cast<CausalEoS*>(&eos))
+        return std::forward<F>(f)(*causal);
+    if(EffectiveBosonicEoS* bosonic = dynamic_cast<EffectiveBosonicEoS*>(&eos))
+        return std::forward<F>(f)(*bosonic);
+    return std::forward<F>(f)(eos);
+}
+
 
 }
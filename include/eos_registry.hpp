@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>   // for std::shared_ptr
+#include <mutex>    // the registry is shared between threads
+#include <cstdint>  // for the fixed-size fields of the cache header
+#include <cstdio>   // for std::rename, std::remove
+#include <exception>    // for std::exception_ptr, the errors of the parallel loading
+
+#include "eos.hpp"
+
+namespace FBS {
+
+/* EoSRegistry
+ * maps the names of the tabulated EoS, e.g. "EOS_DD2", to their files and loads every table only once per process.
+ * The tables are shared by everyone who asks for the same name, also across threads, so they are frozen (see EoStable::freeze)
+ *  before they are handed out. The resampling and the lookup hint are therefore chosen when the name is registered.
+ *  Reading the tables concurrently is safe, see EoStable::upper_index
+ *
+ * Every name has a format (see EoSTableFormat), the bundled tables have the CompOSE format.
+ * add_directory registers all tables in a directory, e.g. the parametric family in EOS_tables/Jan-Erik-EOS/, and loads them in parallel
+ *
+ * With use_cache, the nodes of a table are written to a binary file next to it (filename + ".cache") after it has been parsed,
+ *  and later runs map this file into memory instead of parsing the text again.
+ * The cache stores the size and modification time of the table and is ignored when they don't match,
+ *  or when it was written with a different format or layout of EoStable::Node. If it can't be written, the table is parsed every run */
+class EoSRegistry {
+public:
+    /* The registry of the process, which knows the tables in EOS_tables/ */
+    static EoSRegistry& instance();
+
+    /* Registers a name for a table file in the given format.
+     * If resample_points > 0, the table is resampled with EoStable::resample_log_uniform, use_hint is passed to EoStable::set_use_hint.
+     * Registering a name again with other settings replaces the table for the following calls of get */
+    void add(const std::string& name, const std::string& filename, const EoSTableFormat& format = EoSTableFormat::compose(),
+                const unsigned int resample_points = 0, const bool use_hint = true);
+    /* Registers all files with the extension in the directory under their names without the extension, and loads them in parallel
+     * Returns the registered names in alphabetical order */
+    std::vector<std::string> add_directory(const std::string& directory, const EoSTableFormat& format, const std::string& extension,
+                const unsigned int resample_points = 0, const bool use_hint = true);
+    /* Gives the table registered under the name, loading it on first use. The table is frozen
+     * Returns an empty pointer if the name is unknown, and throws if the file can't be loaded */
+    std::shared_ptr<EoStable> get(const std::string& name);
+    /* The registered names */
+    std::vector<std::string> names() const;
+    /* Releases all loaded tables, the tables stay valid for their current users */
+    void clear();
+
+    /* whether the binary cache is used */
+    bool use_cache;
+
+    /* The name of the cache file of a table */
+    static std::string cache_file(const std::string& filename);
+    /* Loads a table, from the cache if there is a valid one, and writes the cache if it was parsed */
+    static std::shared_ptr<EoStable> load(const std::string& filename, const EoSTableFormat& format, const bool use_cache);
+    /* Writes the nodes of the table to the cache file of the source table.
+     * The file is written under a temporary name and renamed, so that processes running at the same time never read a partial cache */
+    static bool save_cache(const EoStable& table, const std::string& filename, const EoSTableFormat& format);
+    /* Loads the table from the cache file of the source table, returns an empty pointer if there is no valid cache */
+    static std::shared_ptr<EoStable> load_cache(const std::string& filename, const EoSTableFormat& format);
+
+protected:
+    struct Entry {
+        std::string filename;
+        EoSTableFormat format;
+        unsigned int resample_points = 0;
+        bool use_hint = true;
+        std::shared_ptr<EoStable> table;
+    };
+    std::map<std::string, Entry> entries;
+    mutable std::mutex mutex;
+
+    EoSRegistry();
+
+    /* Loads the table of the entry with its settings and freezes it */
+    std::shared_ptr<EoStable> load_entry(const Entry& entry) const;
+};
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>   // for std::vector
+#include <deque>    // for the task queues of the workers
+#include <memory>   // for std::unique_ptr, std::shared_ptr
+#include <functional> // for std::function
+#include <future>   // for std::future, std::promise
+#include <thread>   // for the worker threads
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception> // for std::exception_ptr, the errors of the tasks
+#include <chrono>   // for the polling in wait
+#include <algorithm> // for std::max
+#ifdef _OPENMP
+#include <omp.h>    // for omp_get_max_threads, the default number of workers
+#endif
+
+namespace FBS {
+
+/* Executor
+ * a pool of worker threads that stays alive for the whole run, so that the drivers in mr_curves can hand their stars to
+ *  the same threads, and several curves can be computed at the same time without idle threads at the end of every curve
+ *
+ * Every worker has its own queue of tasks. Tasks submitted by a worker are put into its own queue, the others are spread
+ *  over the queues. A worker runs the newest task of its own queue and steals the oldest task of another queue when its
+ *  own is empty, so the stars of one curve stay close together while idle workers take the rest.
+ * A worker that waits for tasks (see wait) runs other tasks in the meantime, so a task can submit tasks itself and wait
+ *  for them, e.g. a whole curve that is submitted as one task and hands its stars to the executor
+ *
+ * The exceptions of a task are passed on to the future of the task */
+class Executor {
+public:
+    typedef std::function<void()> Task;
+
+    /* The executor of the process, with omp_get_max_threads() workers (i.e. OMP_NUM_THREADS is respected) */
+    static Executor& instance();
+
+    /* Starts the worker threads, at least one */
+    explicit Executor(unsigned int n_workers);
+    /* Finishes the submitted tasks and stops the workers */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /* Submits a task, the future is ready when it is done */
+    std::future<void> submit(Task task);
+    /* Submits the tasks f(0), ..., f(n-1), the future is ready when all are done and holds the first exception of them */
+    std::future<void> submit_range(const std::size_t n, std::function<void(std::size_t)> f);
+    /* As submit_range for the indices in order, which are started in this order regardless of which worker runs them,
+     *  e.g. the most expensive first (see CostModel::longest_first) */
+    std::future<void> submit_ordered(const std::vector<std::size_t>& order, std::function<void(std::size_t)> f);
+    /* Waits for the future. The workers of this executor run other tasks while they wait, other threads just block */
+    void wait(std::future<void>& future);
+    /* Waits for all futures, see wait. The first exception is rethrown after all are done */
+    void wait_all(std::vector<std::future<void>>& futures);
+
+    /* the number of worker threads */
+    unsigned int size() const { return workers.size(); }
+    /* whether the calling thread is one of the workers, i.e. other tasks may run at the same time */
+    bool is_worker() const { return this->worker_index() >= 0; }
+
+protected:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;     // one for every worker
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> pending;               // the number of tasks in the queues
+    std::atomic<unsigned int> next_queue;           // for the tasks from outside the workers
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    /* puts the task into a queue and wakes a worker */
+    void push(Task task);
+    /* runs a task from the queue of the worker, or stolen from another queue. Returns false if all queues are empty */
+    bool run_one(const unsigned int worker);
+    /* the loop of the worker threads */
+    void work(const unsigned int worker);
+    /* the index of the calling thread among the workers of this executor, or -1 */
+    int worker_index() const;
+};
+
+}
@@ -5,6 +5,9 @@
 #include "eos.hpp"
 #include "plotting.hpp"
 #include "nsmodel.hpp"
+#include "utilities.hpp"  // for brent_zeroin, the search for omega
+
+#include <limits>   // for the machine epsilon in the search for omega
 
 #define PHI_converged 1e-4 // compared to phi / phi_0, when the bosonic component has converged sufficiently
 #define INT_converged 1e-7
@@ -37,15 +40,21 @@ namespace FBS {
  */
 class FermionBosonStar : public NSmodel {
 protected:
-    /* Calculates the parameters M_T, N_B, N_F, R_B, R_F_0 for a given integration contained in results,events */
-    void calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events);
+    /* Calculates the parameters M_T, N_B, N_F, R_B, R_F_0 for a given integration contained in results,events
+     * The temporary arrays are taken from the workspace if given (array slots 0-3) */
+    void calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events, Workspace* workspace=nullptr);
 
-    int find_bosonic_convergence(std::vector<integrator::step>& results, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOps, double& R_B_0, bool force=false, double r_init=-1., double r_end=-1.) const;
+    int find_bosonic_convergence(integrator::Trajectory& results, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOps, double& R_B_0, bool force=false, double r_init=-1., double r_end=-1.) const;
     /* Integrates the star until the bosonic field is sufficiently converged phi/phi_0 < PHI_converged, pauses the integration, sets phi=0, and continues the integration
-     * to avoid the divergence that is otherwise present due to numerical properties of the system. Only call when omega is found after the bisection! */
-    int integrate_and_avoid_phi_divergence(std::vector<integrator::step>& result, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), bool force = false, std::vector<int> additional_zero_indices={}, double r_init=-1., double r_end=-1.);
+     * to avoid the divergence that is otherwise present due to numerical properties of the system. Only call when omega is found after the bisection!
+     * The continued integration is held in trajectory slot 1 of the workspace if given */
+    int integrate_and_avoid_phi_divergence(integrator::Trajectory& result, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), bool force = false, std::vector<int> additional_zero_indices={}, double r_init=-1., double r_end=-1., Workspace* workspace=nullptr);
 
     int bisection_converge_through_infty_behavior(double omega_0, double omega_1, int n_mode, int max_steps, double delta_omega, int verbose);
+    /* The same with the steps of Brent's method on the signed amplitude of the diverging field instead of bisection steps on its sign */
+    int brent_converge_through_infty_behavior(double omega_0, double omega_1, int n_mode, int max_steps, double delta_omega, int verbose);
+    /* Calls one of the two functions above, depending on omega_solver */
+    int converge_through_infty_behavior(double omega_0, double omega_1, int n_mode, int max_steps, double delta_omega, int verbose);
     int bisection_find_mode(double& omega_0, double& omega_1, int n_mode, int max_steps, int verbose);
     int bisection_expand_range(double& omega_0, double& omega_1, int n_mode, int& n_roots_0, int& n_roots_1, int verbose);
 
@@ -54,16 +63,37 @@ protected:
     double rho_0, phi_0;
     double M_T, N_B, N_F, R_B, R_B_0, R_F, R_F_0, R_G;
 
+    /* The method of the last stage of the search for omega, where the field has the right number of roots:
+     *  sign_bisection  : bisection on the sign of phi where the integration diverges
+     *  brent           : Brent's method (safeguarded secant and inverse quadratic interpolation steps) on the signed amplitude
+     *                    of the diverging field, which needs fewer integrations */
+    enum omega_solver_method {sign_bisection=0, brent};
+    omega_solver_method omega_solver;
+    /* The number of integrations of all searches for omega of this star, for comparing the methods */
+    int omega_integrations;
+
     /* Constructor for the FBS class, just sets the relevant values of the class */
     FermionBosonStar(std::shared_ptr<EquationOfState> EOS, double mu, double lambda=0., double omega=0., double rho_0=0., double phi_0=0.)
-            : NSmodel(EOS), mu(mu), lambda(lambda), omega(omega), rho_0(rho_0), phi_0(phi_0), M_T(0.), N_B(0.), N_F(0.), R_B(0.), R_B_0(0.), R_F(0.), R_F_0(0.), R_G(0.) {}
+            : NSmodel(EOS), mu(mu), lambda(lambda), omega(omega), rho_0(rho_0), phi_0(phi_0), M_T(0.), N_B(0.), N_F(0.), R_B(0.), R_B_0(0.), R_F(0.), R_F_0(0.), R_G(0.),
+                omega_solver(sign_bisection), omega_integrations(0) {}
 
     /* The differential equations describing the FBS. The quantities are a, alpha, P, phi, and Psi, as described in https://arxiv.org/pdf/2110.11997.pdf */
     vector dy_dr(const double r, const vector& vars) const;
+    /* The same equations for the fixed-dimension integrator, which does not allocate memory during the integration */
+    virtual fixed_vector<5> dy_dr(const double r, const fixed_vector<5>& vars) const;
+    /* The same equations with the EoS of type E, the calls to the EoS are not virtual if E is a concrete EoS (see dispatch_eos) */
+    template <typename E>
+    fixed_vector<5> dy_dr(const double r, const fixed_vector<5>& vars, E& EoS) const;
+
+    /* Calls the fixed-dimension integrator for the 5 variables a, alpha, phi, Psi, P */
+    int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
 
     /* This function requires mu, lambda, rho_0, phi_0 to be set. It finds the corresponding eigenfrequency omega for the nth mode.
      * omega_0, and omega_1 describe a range in which omega is expected, but the function can extend that range if found to be insufficient*/
     int bisection(double omega_0, double omega_1, int n_mode=0, int max_step=200, double delta_omega=1e-16, int verbose=0);
+    /* The same, but starts from a guess for omega, e.g. extrapolated from neighbouring stars, with the range omega_guess*(1 -+ rel_width).
+     * The range is widened until it contains the nth mode, if this fails the bisection starts over with (omega_0, omega_1) */
+    int bisection_warm_start(double omega_guess, double rel_width, double omega_0, double omega_1, int n_mode=0, int max_step=200, double delta_omega=1e-16, int verbose=0);
 
     /* The initial conditions for a, alpha, phi, Psi, and P */
     virtual vector get_initial_conditions(double r_init=-1.) const;
@@ -73,9 +103,11 @@ protected:
 
     /* Integrates the DE while avoiding the phi divergence and calculates the FBS properties
      * Returns the results and optionally ouputs them into a file*/
-    void evaluate_model(std::vector<integrator::step>& results, integrator::IntegrationOptions intOpts= integrator::IntegrationOptions(), std::string filename="");
+    void evaluate_model(integrator::Trajectory& results, integrator::IntegrationOptions intOpts= integrator::IntegrationOptions(), std::string filename="", Workspace* workspace=nullptr);
     /* Wrapper if the results are not wanted */
     void evaluate_model();
+    /* Same, but the memory is taken from the workspace (trajectory slots 0-1, array slots 0-3), which can be reused for the next star */
+    void evaluate_model(Workspace& workspace);
 
     /* This function outputs parameters and properties, in the order given by the labels function */
     friend std::ostream& operator <<(std::ostream&, const FermionBosonStar&);
@@ -86,6 +118,28 @@ protected:
 
 };
 
+/* FermionBosonStarDivergenceObserver
+ * follows the integration of a FermionBosonStar with omega close to an eigenfrequency, where the field diverges eventually.
+ * It accumulates the WKB exponent K = int k dr of the growing solution, with k = a sqrt(dV/d(phi^2) - omega^2/alpha^2) where positive,
+ *  and records K, r and Psi at the last point where |Psi| grows through Psi_sample with phi and Psi of the same sign, i.e. where
+ *  the growing solution dominates the field, but is still too small to act back on the metric (used by brent_converge_through_infty_behavior) */
+class FermionBosonStarDivergenceObserver : public integrator::Observer {
+public:
+    static const double Psi_sample;
+    double r, Psi, K;
+    bool found;
+
+    FermionBosonStarDivergenceObserver(const FermionBosonStar& fbs) : fbs(fbs) { this->reset(); }
+
+    void reset();
+    void observe(const double r, const vector& y, const vector& dy);
+
+protected:
+    const FermionBosonStar& fbs;
+    double last_r, last_k, K_now;
+    bool above;     // whether the last step was above Psi_sample
+};
+
 std::ostream& operator <<(std::ostream&, const FermionBosonStar&);
 
 }
@@ -1,15 +1,55 @@
 #pragma once
 
 #include <utility>  // for std::swap
+#include <memory>   // for std::shared_ptr, the background that is shared by the copies of a star
+#include <algorithm> // for std::upper_bound
+#include <array>    // for the coefficient polynomials of the background
 
 #include "vector.hpp"
 #include "eos.hpp"
 #include "plotting.hpp"
 #include "nsmodel.hpp"
 #include "fbs.hpp"
+#include "workspace.hpp"   // for the thread-local workspace of the perturbations
 
 namespace FBS {
 
+class FermionBosonStarTLN;
+
+/* FermionBosonStarBackground
+ * holds the background a, alpha, phi, Psi, P of a FermionBosonStar, as integrated by FermionBosonStar::evaluate_model,
+ *  together with the derivatives at every step, so that the perturbations of a FermionBosonStarTLN can be integrated
+ *  without evaluating the equations of the background (and the EoS) again
+ * Between the steps, the background is given by the cubic Hermite interpolation, see integrator::dense_output
+ * The coefficients of the perturbation equations (see FermionBosonStarTLN::perturbation_coefficients) are evaluated once
+ *  at the steps and at 1/3 and 2/3 of every step, and are given by the cubic polynomial through these values in between,
+ *  so the integration of the perturbations doesn't need the EoS
+ * At R_B_0, where phi and Psi were set to 0, both states are kept, as the steps before and after R_B_0 */
+class FermionBosonStarBackground {
+protected:
+    std::vector<double> radii;
+    std::vector<fixed_vector<5>> y_steps, dy_steps;
+    /* the (scaled, see the constructor) coefficients in the step [radii[i], radii[i+1]) are p[0] + t (p[1] + t (p[2] + t p[3])) with t = (r - radii[i])/(radii[i+1] - radii[i]) */
+    std::vector<std::array<fixed_vector<6>, 4>> coefficient_polynomials;
+    std::size_t index_R_B_0;    // the first step after phi and Psi were set to 0, or 0
+
+    /* The step i with radii[i] <= r < radii[i+1] on the side of R_B_0, r outside of the range gives the first or last step
+     * The search starts at hint, which is updated, so that it is fast when r changes little between the calls */
+    std::size_t find_step(const double r, const bool after_R_B_0, std::size_t& hint) const;
+
+public:
+    /* Takes the background from the results of FermionBosonStar::evaluate_model for the parent of the star */
+    FermionBosonStarBackground(const FermionBosonStarTLN& star, const integrator::Trajectory& results);
+
+    /* The background y and its derivatives dy at r. after_R_B_0 chooses the steps before or after phi and Psi were set to 0 */
+    void interpolate(const double r, const bool after_R_B_0, fixed_vector<5>& y, fixed_vector<5>& dy, std::size_t& hint) const;
+    /* The coefficients of the perturbation equations at r */
+    fixed_vector<6> coefficients(const double r, const bool after_R_B_0, std::size_t& hint) const;
+
+    double r_end() const { return radii.back(); }
+    std::size_t size() const { return radii.size(); }
+};
+
 /* FermionBosonStarTLN
  * This class models a perturbed fermion boson star (FBS). Here, the perturbations
  *  are described by the metric perturbation H(r) and bosonic field perturbation phi_1(r)
@@ -31,15 +71,34 @@ namespace FBS {
  *   all parameters consistent and properties calculated!
  *
  *  The normalization of H, phi_1 is arbitrary and only affects each other. Therefore, H_0 = 1 usually
- *  The corresponding phi_1_0 can be found with another bisection algorithm
+ *  The corresponding phi_1_0 can be found with another bisection algorithm, or from the superposition of two solutions,
+ *   as the perturbation equations are linear
+ *
+ *  If the background of the star is given (see set_background), the integrations only integrate H, dH, phi_1, dphi_1,
+ *   with the coefficients of the perturbation equations taken from the background, so neither the background equations nor the EoS are evaluated
  */
 class FermionBosonStarTLN : public FermionBosonStar {
 protected:
     /* Calculates the parameters lambda_tidal, k2, y_max, R_ext for a given integration contained in results,events */
-    void calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events);
+    void calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events);
+
+    /* Integrates only the perturbations of n_solutions = 1 or 2 solutions, forced by the background
+     *  (see FermionBosonStarBackground), so the integrator sees 4 or 8 variables.
+     * The results, the events and the observer still see the full state of 9 or 13 variables, with the interpolated background
+     * The side of R_B_0 is fixed for the whole integration, by whether it starts after R_B_0,
+     *  as FermionBosonStar::integrate_and_avoid_phi_divergence restarts there with phi = Psi = 0
+     * The perturbations are integrated in trajectory slot 2 of the thread-local workspace */
+    int integrate_perturbations(const unsigned int n_solutions, integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector& initial_conditions,
+                                    const integrator::IntegrationOptions& intOpts, double r_init, double r_end, integrator::Observer* observer) const;
+
+    std::shared_ptr<const FermionBosonStarBackground> background;
+    mutable std::size_t background_hint;    // the last step of the background that was used, see FermionBosonStarBackground::find_step
 
 
     int bisection_phi_1_find_mode(double& phi_1_0_l, double& phi_1_0_r, int n_mode, int max_steps, int verbose);
+    /* For the ground state, if the roots of phi_1 don't bracket it: checks that the sign of phi_1 where it diverges differs at the ends of the range.
+     *  Otherwise the range is extended to (-phi_1_0_r, phi_1_0_r), as phi_1_0 is of the order of the integration error and can have either sign */
+    int bisection_phi_1_sign_range(double& phi_1_0_l, double& phi_1_0_r, int verbose);
     int bisection_phi_1_converge_through_infty_behavior(double& phi_1_0_l, double& phi_1_0_r, int max_steps, double delta_phi_1, int verbose);
 
 
@@ -50,20 +109,38 @@ public:
     /*FermionBosonStarTLN(std::shared_ptr<EquationOfState> EOS, double mu, double lambda, double omega)
         : FermionBosonStar(EOS, mu, lambda, omega), H_0(1.), phi_1_0(0.), lambda_tidal(0.), k2(0.), y_max(0.), R_ext(0) {}*/ // TODO: Check, this shouldn't work without call to evaluate_model of the parent class
     /* The constructor for the class. Assumes that the FermionBosonStar has its properties calculated! */
-    FermionBosonStarTLN(const FermionBosonStar& fbs) : FermionBosonStar(fbs), H_0(1.), phi_1_0(0.), lambda_tidal(0.), k2(0.), y_max(0.), R_ext(0.) {  }
+    FermionBosonStarTLN(const FermionBosonStar& fbs) : FermionBosonStar(fbs), background_hint(0), H_0(1.), phi_1_0(0.), lambda_tidal(0.), k2(0.), y_max(0.), R_ext(0.) {  }
+
+    /* The coefficients of the linear perturbation equations for the background a, alpha, phi, Psi, P with the derivatives dy_dr,
+     *  ddH_dr2 = c[0] dH + c[1] H + c[2] phi_1,  ddphi_1_dr2 = c[3] dphi_1 + c[4] H + c[5] phi_1 */
+    fixed_vector<6> perturbation_coefficients(const double r, const fixed_vector<5>& vars, const fixed_vector<5>& dy_dr) const;
 
     /* The differential equations describing the FBS + TLN. The quantities are a, alpha, phi, Psi, P, H, dH, phi_1, dphi_1 */
     vector dy_dr(const double r, const vector& vars) const;
+    /* The same equations for the fixed-dimension integrator, which does not allocate memory during the integration */
+    virtual fixed_vector<9> dy_dr(const double r, const fixed_vector<9>& vars) const;
+
+    /* Calls the fixed-dimension integrator for the 9 variables, or integrates only the perturbations if the background is given */
+    int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
 
     /* The initial conditions for a, alpha, phi, Psi, P, H, dH, phi_1, dphi_1*/
     vector get_initial_conditions(double r_init=R_INIT) const;
 
+    /* Uses the results of FermionBosonStar::evaluate_model of the parent star as the background of the following integrations,
+     *  which then end at the end of the background. Returns -1 if phi didn't converge in the results, then the background isn't used */
+    int set_background(const integrator::Trajectory& results);
+    /* Removes the background (e.g. to free its memory), the following integrations solve the background equations again */
+    void clear_background();
+
     /* This function requires the FBS parameters and H_0 to be set. It finds the corresponding phi_1_0 */
     int bisection_phi_1(double phi_1_0, double phi_1_1, int n_mode=0, int max_step=200, double delta_phi_1=1e-12, int verbose = 0);
+    /* The same without a bisection: the solutions for (H_0, phi_1_0) = (1, 0) and (0, 1) are integrated at once with the background
+     *  (see FermionBosonStarTLNBasis), and phi_1_0 is chosen such that the diverging parts of phi_1 cancel. Needs a single integration */
+    int superposition_phi_1(int verbose = 0);
 
     /* Integrates the DE while avoiding the phi divergence and calculates the FBS properties
      * Returns the results and optionally ouputs them into a file*/
-    void evaluate_model(std::vector<integrator::step>& results, std::string filename="");
+    void evaluate_model(integrator::Trajectory& results, std::string filename="");
     void evaluate_model();
 
     /* This function outputs parameters and properties, in the order given by the labels function */
@@ -74,6 +151,29 @@ public:
     static const integrator::Event dphi_1_diverging, phi_1_negative, phi_1_positive;
 };
 
+/* FermionBosonStarTLNBasis
+ * integrates the background of a FermionBosonStarTLN together with two solutions of the perturbation equations,
+ *  with H_0 = 1, phi_1_0 = 0 and with H_0 = 0, phi_1_0 = 1, which every solution is a linear combination of
+ * The quantities are a, alpha, phi, Psi, P, and H, dH, phi_1, dphi_1 for both solutions
+ * Used by FermionBosonStarTLN::superposition_phi_1 */
+class FermionBosonStarTLNBasis : public FermionBosonStarTLN {
+public:
+    FermionBosonStarTLNBasis(const FermionBosonStarTLN& fbs) : FermionBosonStarTLN(fbs) {  }
+
+    /* The differential equations describing the FBS with both perturbations */
+    vector dy_dr(const double r, const vector& vars) const;
+    fixed_vector<13> dy_dr(const double r, const fixed_vector<13>& vars) const;
+
+    /* Calls the fixed-dimension integrator for the 13 variables, or integrates only the perturbations if the background is given */
+    int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
+
+    /* The initial conditions for a, alpha, phi, Psi, P and the perturbations of both solutions */
+    vector get_initial_conditions(double r_init=R_INIT) const;
+
+    /* This event triggers when dphi_1 of either solution is diverging */
+    static const integrator::Event dphi_1_diverging;
+};
+
 std::ostream& operator<<(std::ostream&, const FermionBosonStarTLN&);
 
 }
@@ -4,21 +4,29 @@
 #include <vector>   // for std::vector
 #include <utility>  // for std::pair
 #include <stdexcept> // for std::runtime_error
+#include <algorithm> // for std::max
+#include <cmath>     // for std::abs
 
 #include "vector.hpp"
+#include "trajectory.hpp"
 
 namespace FBS {
 
 // A class to hold the ODE solver with the option to define events during integration.
 namespace integrator
 {
-    /* Define the ODE_system value, which is e.g. the dy_dr in the NSmodel class. v2 has knowledge on previous integation step */
-    typedef vector (*ODE_system)(const double, const vector& , const void*);
+    /* Define the ODE_system value, which is e.g. the dy_dr in the NSmodel class. v2 has knowledge on previous integation step
+     * The State can either be the dynamic FBS::vector or a fixed_vector<N>, which keeps all intermediate steps on the stack
+     * The templated steppers take the right hand side as any callable RHS with the signature of ODE_system_t<State>.
+     *  A function object (see NSmodel::ModelRHS) lets the compiler inline the equations into the stages,
+     *  function pointers can still be passed as before */
+    template <typename State>
+    using ODE_system_t = State (*)(const double, const State&, const void*);
+    typedef ODE_system_t<vector> ODE_system;
+    template <std::size_t N>
+    using ODE_system_fixed = ODE_system_t<fixed_vector<N>>;
     typedef vector (*ODE_system_v2)(const double, const vector&, const double, const vector&, const void*);
 
-    /* the integrator works in steps of r and the integrated variables */
-    typedef std::pair<double, vector> step;
-
     /* function pointer to event conditions, tests whether a condition is fulfilled */
     typedef bool (*event_condition)(const double r, const double dr, const vector& y, const vector& dy, const void*params);
     /* typedef std::function<bool(const double r, const double dr, const vector& y, const vector& dy, const void*params)> event_condition;*/
@@ -31,7 +39,9 @@ namespace integrator
      *                          in that case event_stopping_condition is return_reason, then the causing event can be found out with the active field
      *  steps               : A list of steps where the event BECAME active (NOT all points where event is active)
      *  name                : An optional name parameter
-     *  active              : Is a field used by the integrator to save whether it is active or not */
+     *  active              : Is a field used by the integrator to save whether it is active or not
+     *  target_accuracy     : If > 0, the integrator locates the point where the event becomes active up to this accuracy in r
+     *                          and places a step there (see RKF45_step_event_tester) */
     struct Event {
         event_condition condition;
         bool stopping_condition;
@@ -45,6 +55,17 @@ namespace integrator
         void reset() { steps.clear(); active=false; }
     };
 
+    /* Observer
+     * An interface for objects that follow the integration step by step, e.g. to compute integrals over the solution
+     *  or to find extraction points without keeping all steps in memory
+     * observe is called with the initial values and after every step of the integration (the same steps that are saved
+     *  in the results Trajectory with save_intermediate=true), with the position r, the values y and the derivatives dy */
+    class Observer {
+    public:
+        virtual void observe(const double r, const vector& y, const vector& dy) = 0;
+        virtual ~Observer() {}
+    };
+
     /* Simple output for the step type */
     std::ostream& operator <<(std::ostream& o, const step& s);
 
@@ -58,7 +79,14 @@ namespace integrator
      *  save_intermediate : Whether the integrator should save all steps in the results vector or just the initial and last steps
      *  verbose       : How verbose the integrator should be
      *  clean_events  : Whether to call event->reset before integration - Default is true, put to false when continuing an integration for example
+     *  method        : The Runge-Kutta stepper to use, see step_method. The default is RKF45, the Dormand-Prince stepper has to be chosen explicitly
      */
+    /* The available Runge-Kutta steppers
+     *  rkf45   : Runge-Kutta-Fehlberg 4(5), 6 evaluations of dy_dr per step
+     *  dopri5  : Dormand-Prince 5(4), the last stage is the derivative at the new point (first same as last, FSAL)
+     *              and is reused for the next step and the event checks, so effectively 6 evaluations per step are needed */
+    enum step_method {rkf45=0, dopri5};
+
     struct IntegrationOptions {
         int max_step;
         double target_error;
@@ -68,31 +96,543 @@ namespace integrator
         bool save_intermediate;
         int verbose;
         bool clean_events;
-        IntegrationOptions(const int max_step=1000000, const double target_error=1e-14, const double min_stepsize=1e-16, const double max_stepsize=1e-2, const bool force_max_stepsize=false, const bool save_intermediate=false, const int verbose=0, bool clean_events=true)
-                            : max_step(max_step), target_error(target_error), min_stepsize(min_stepsize), max_stepsize(max_stepsize), force_max_stepsize(force_max_stepsize), save_intermediate(save_intermediate), verbose(verbose), clean_events(clean_events) {}
+        step_method method;
+        IntegrationOptions(const int max_step=1000000, const double target_error=1e-14, const double min_stepsize=1e-16, const double max_stepsize=1e-2, const bool force_max_stepsize=false, const bool save_intermediate=false, const int verbose=0, bool clean_events=true, step_method method=rkf45)
+                            : max_step(max_step), target_error(target_error), min_stepsize(min_stepsize), max_stepsize(max_stepsize), force_max_stepsize(force_max_stepsize), save_intermediate(save_intermediate), verbose(verbose), clean_events(clean_events), method(method) {}
     };
 
     /* define return codes for the integrator */
     enum  return_reason  {endpoint_reached=1, stepsize_underflow, iteration_number_exceeded,  event_stopping_condition};
 
-    /* Runge-Kutta Fehlberg stepper that does one step at a time */
+    /* StepController
+     * proportional-integral (PI) controller for the stepsize of the Runge-Kutta steppers
+     * The new stepsize is scaled by  safety * (err/target)^(-alpha) * (err_prev/target)^beta  and is bounded by fac_min, fac_max
+     * The error estimate of the steppers (see RKF45_step) scales as dr^6, so the exponents are alpha = 0.7/6, beta = 0.4/6
+     * After a rejected step, the stepsize is not increased in the following step
+     *  err_prev    : the ratio err/target of the last accepted step
+     *  rejected    : whether the last attempt was rejected */
+    struct StepController {
+        static constexpr double safety = 0.9, fac_min = 0.2, fac_max = 5., alpha = 0.7/6., beta = 0.4/6.;
+        double err_prev;
+        bool rejected;
+        StepController() : err_prev(1e-4), rejected(false) {}
+
+        /* gives the factor for the stepsize after an accepted step with error ratio err = truncation_error/target_error */
+        double accept(double err) {
+            err = std::max(err, 1e-10);
+            double fac = safety * std::pow(err, -alpha) * std::pow(err_prev, beta);
+            fac = std::min(fac_max, std::max(fac_min, fac));
+            if(rejected)
+                fac = std::min(1., fac);
+            err_prev = err;
+            rejected = false;
+            return fac;
+        }
+        /* gives the factor for the stepsize after a rejected step with error ratio err > 1 */
+        double reject(double err) {
+            rejected = true;
+            return std::max(fac_min, safety * std::pow(err, -1./6.));
+        }
+    };
+
+    /* Runge-Kutta Fehlberg stepper that does one step at a time
+     * The templated versions work for any State, the overloads for FBS::vector are kept for compatibility
+     * dy has to contain the derivative at (r, y), it is the first stage of the step and of all its retries */
+    template <typename State, typename RHS>
+    bool RKF45_step(const RHS& dy_dr, double &r, double &dr, State& y, const State& dy, const void* params, const IntegrationOptions& options, StepController& controller);
     bool RKF45_step(ODE_system dy_dr, double &r, double &dr, vector& y, const void* params, const IntegrationOptions& options);
     bool RKF45_step(ODE_system_v2 dy_dr, double &r, double &dr, vector& y, double &r_prev, vector& y_prev, const void* params, const IntegrationOptions& options);
 
-    /* Checks if events require smaller stepsize and only accepts steps if they do*/
+    /* Dormand-Prince stepper that does one step at a time
+     * dy has to contain the derivative at (r, y) and is updated to the derivative at the new point (FSAL) */
+    template <typename State, typename RHS>
+    bool DoPri5_step(const RHS& dy_dr, double &r, double &dr, State& y, State& dy, const void* params, const IntegrationOptions& options, StepController& controller);
+
+    /* Dense output of a step from (r0, y0) to (r1, y1) with the derivatives dy0, dy1: gives y and dy at r0 <= r <= r1 */
+    template <typename State>
+    void dense_output(const double r0, const State& y0, const State& dy0, const double r1, const State& y1, const State& dy1,
+                                            const double r, State& y, State& dy);
+
+    /* Locates the crossing of an event inside a step with the dense output, up to event.target_accuracy */
+    template <typename State>
+    double locate_event(const Event& event, const double r0, const State& y0, const State& dy0, const double r1, const State& y1, const State& dy1, const void* params);
+
+    /* Checks if events require smaller stepsize and repeats the step to end at the crossing if they do
+     * Uses the stepper given in options.method. dy has to contain the derivative at the current step and is updated with the step */
+    template <typename State, typename RHS>
+    int RKF45_step_event_tester(const RHS& dy_dr, std::pair<double, State>& current_step, State& dy, double& dr, const void* params,
+                                            const std::vector<Event>& events, const IntegrationOptions& options, StepController& controller);
     int RKF45_step_event_tester(ODE_system dy_dr, step& current_step, double& dr, const void* params,
                                             const std::vector<Event>& events, const IntegrationOptions& options);
     int RKF45_step_event_tester(ODE_system_v2 dy_dr, step& current_step, step& prev_step, double& dr, const void* params,
                                             const std::vector<Event>& events, const IntegrationOptions& options);
 
-    /* Full Runge-Kutta Fehlberg IVP integrator, steps are output in results vector*/
+    /* Estimates a starting stepsize for an integration at r0 with values y0 and derivative dy0 (Hairer, Norsett, Wanner, Solving ODEs I, II.4)
+     * The result lies between options.min_stepsize and options.max_stepsize */
+    template <typename State, typename RHS>
+    double initial_stepsize(const RHS& dy_dr, const double r0, const State& y0, const State& dy0, const void* params, const IntegrationOptions& options);
+
+    /* Full Runge-Kutta IVP integrator, steps are output in the results Trajectory and passed to the observer (if given)
+     * The name is kept for compatibility, the stepper is chosen with options.method */
+    template <typename State, typename RHS>
+    int RKF45(const RHS& dy_dr, const double r0, const State& y0, const double r_end, const void* params,
+                            Trajectory& results, std::vector<Event>& events, const IntegrationOptions& options, Observer* observer=nullptr);
     int RKF45(ODE_system dy_dr, const double r0, const vector y0, const double r_end, const void* params,
-                            std::vector<step>& results, std::vector<Event>& events, const IntegrationOptions& options);
+                            Trajectory& results, std::vector<Event>& events, const IntegrationOptions& options, Observer* observer=nullptr);
     int RKF45(ODE_system_v2 dy_dr, const double r0, const vector y0, const double r_end, const void* params,
                             std::vector<step>& results, std::vector<Event>& events, const IntegrationOptions& options);
     /* A simple cumulative trapezoid integration algorithm */
     void cumtrapz(const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& res);
 
+    /* Events and observers are formulated with FBS::vector. This helper converts the State if necessary,
+     * a fixed_vector is copied into a preallocated buffer to avoid allocations */
+    inline const vector& as_vector(const vector& y, vector& buffer) { return y; }
+    template <std::size_t N>
+    const vector& as_vector(const fixed_vector<N>& y, vector& buffer) {
+        if(buffer.size() != N)
+            buffer.resize(N);
+        for(unsigned i = 0; i < N; i++)
+            buffer[i] = y[i];
+        return buffer;
+    }
+
+}
+
+/* Template functions must be defined in the header file: */
+
+/* This function takes as input the ODE_system, the position r, the current stepsize dr, the parameters y and their derivative dy
+ * It perfoms one RKF45 step and saves the results in the updated r, stepsize dr and y
+ * The stepsize for the next step (or the retry of a rejected step) is chosen by the controller
+ * All stages are computed in fused loops over the components, so for a fixed_vector State no memory is allocated
+ * */
+template <typename State, typename RHS>
+bool integrator::RKF45_step(const RHS& dy_dr, double &r, double &dr, State& y, const State& dy, const void* params, const IntegrationOptions& options, StepController& controller)
+{
+    // intermediate steps:
+    const unsigned int n = y.size();
+    State k1(y), k2(y), k3(y), k4(y), k5(y), k6(y), y_stage(y), dV_04(y), dV_05(y);
+
+    // solve until we find an acceptable stepsize/error:
+    while (true) {
+
+        // runge kutta Fehlberg steps for all ODEs:
+        const State& f1 = dy;
+        for(unsigned int i = 0; i < n; i++) {
+            k1[i] = dr * f1[i];
+            y_stage[i] = y[i] + 1.0 / 4.0 * k1[i];
+        }
+        const State f2 = dy_dr(r + 1.0 / 4.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++) {
+            k2[i] = dr * f2[i];
+            y_stage[i] = y[i] + 3.0 / 32.0 * k1[i] + 9.0 / 32.0 * k2[i];
+        }
+        const State f3 = dy_dr(r + 3.0 / 8.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++) {
+            k3[i] = dr * f3[i];
+            y_stage[i] = y[i] + 1932.0 / 2197.0 * k1[i] - 7200.0 / 2197.0 * k2[i] + 7296.0 / 2197.0 * k3[i];
+        }
+        const State f4 = dy_dr(r + 12.0 / 13.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++) {
+            k4[i] = dr * f4[i];
+            y_stage[i] = y[i] + 439.0 / 216.0 * k1[i] - 8.0 * k2[i] + 3680.0 / 513.0 * k3[i] - 845.0 / 4104.0 * k4[i];
+        }
+        const State f5 = dy_dr(r + dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++) {
+            k5[i] = dr * f5[i];
+            y_stage[i] = y[i] - 8.0 / 27.0 * k1[i] + 2.0 * k2[i] - 3544.0 / 2565.0 * k3[i] + 1859.0 / 4104.0 * k4[i] - 11.0 / 40.0 * k5[i];
+        }
+        const State f6 = dy_dr(r + 1.0 / 2.0 * dr, y_stage, params);
+
+        // 4th and 5th order accurate steps and the truncation error (inf-Norm):
+        double truncation_error = 0.;
+        for(unsigned int i = 0; i < n; i++) {
+            k6[i] = dr * f6[i];
+            dV_04[i] = 25.0 / 216.0 * k1[i] + 1408.0 / 2565.0 * k3[i] + 2197.0 / 4104.0 * k4[i] - 1.0 / 5.0 * k5[i]; // + O(x^5)
+            dV_05[i] = 16.0 / 135.0 * k1[i] + 6656.0 / 12825.0 * k3[i] + 28561.0 / 56430.0 * k4[i] - 9.0 / 50.0 * k5[i] + 2.0 / 55.0 * k6[i]; // + O(x^6)
+            truncation_error = std::max(truncation_error, std::abs(dV_05[i] - dV_04[i]));
+        }
+
+        if( State::is_nan(dV_05) || State::is_nan(dV_04)) {
+            dr *= 0.5;
+            if (dr < options.min_stepsize) {
+                if(options.verbose > 0)
+                    std::cout << "Nan found" << dV_05 << dV_04 << k1 << k2 << k3 << k4 << k5 << k6 << "\n  for r=" << r << ", dr=" << dr <<  std::endl;
+                throw std::runtime_error("NaN detected");
+            }
+            if(options.verbose > 3)
+                std::cout << "step not precise enough and stepsize decreased creased: dr = " << dr << std::endl;
+            continue;
+        }
+
+        if (options.force_max_stepsize) {	// note: this will ignore target truncation error
+            r += dr;
+            for(unsigned int i = 0; i < n; i++)
+                y[i] += dV_05[i];
+            dr = options.max_stepsize;
+            return true;
+        }
+
+        // approximating the truncation error:
+        truncation_error *= dr;
+
+        if (truncation_error > options.target_error) {
+            const double dr_taken = dr;
+            dr *= controller.reject(truncation_error/options.target_error);     // truncation error is too large. We repeat the iteration with smaller stepsize
+
+            if (dr < options.min_stepsize) {
+                // error is not acceptable but the stepsize cannot get any smaller:
+                // write new values for r and the evolved quantities
+                r += dr_taken;
+                for(unsigned int i = 0; i < n; i++)
+                    y[i] += dV_05[i];
+
+                dr = options.min_stepsize; // ensure that the stepsize never gets too small
+                if(options.verbose > 0) {
+                    std::cout << "Error in RKF45_step(): Minimal stepsize underflow at r = " << r << ", dr = "<< dr << std::endl;  // error message for debugging
+                    std::cout << "Truncation error = "<< truncation_error << std::endl;
+                    std::cout << y << std::endl;
+                }
+                return false;
+            }
+
+            if(options.verbose > 3)
+                std::cout << "step not precise enough and stepsize decreased creased: dr = " << dr << std::endl;
+            continue;
+        }
+        else {
+            // error is small enough and therefore we can use this step. To save computation time, we then increase the stepsize
+            r += dr;
+            for(unsigned int i = 0; i < n; i++)
+                y[i] += dV_05[i];
+
+            dr *= controller.accept(truncation_error/options.target_error);
+            if (dr > options.max_stepsize)
+                dr = options.max_stepsize;   // enforce maximal stepsize
+
+            if(options.verbose > 3){
+                std::cout << "step accepted and stepsize adjusted: dr = " << dr << std::endl;
+            }
+            return true;
+        }
+    }
+}
+
+/* This function takes as input the ODE_system, the position r, the current stepsize dr, the parameters y and their derivative dy
+ * It perfoms one Dormand-Prince 5(4) step and saves the results in the updated r, stepsize dr, y and dy
+ * The seventh stage is evaluated at the new point, so it is returned in dy and serves as the first stage of the next step
+ * The stepsize control is the same as in RKF45_step
+ * */
+template <typename State, typename RHS>
+bool integrator::DoPri5_step(const RHS& dy_dr, double &r, double &dr, State& y, State& dy, const void* params, const IntegrationOptions& options, StepController& controller)
+{
+    // intermediate steps:
+    const unsigned int n = y.size();
+    State y_stage(y), y_new(y);
+
+    // solve until we find an acceptable stepsize/error:
+    while (true) {
+        const State& f1 = dy;
+        for(unsigned int i = 0; i < n; i++)
+            y_stage[i] = y[i] + dr * (1.0 / 5.0 * f1[i]);
+        const State f2 = dy_dr(r + 1.0 / 5.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++)
+            y_stage[i] = y[i] + dr * (3.0 / 40.0 * f1[i] + 9.0 / 40.0 * f2[i]);
+        const State f3 = dy_dr(r + 3.0 / 10.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++)
+            y_stage[i] = y[i] + dr * (44.0 / 45.0 * f1[i] - 56.0 / 15.0 * f2[i] + 32.0 / 9.0 * f3[i]);
+        const State f4 = dy_dr(r + 4.0 / 5.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++)
+            y_stage[i] = y[i] + dr * (19372.0 / 6561.0 * f1[i] - 25360.0 / 2187.0 * f2[i] + 64448.0 / 6561.0 * f3[i] - 212.0 / 729.0 * f4[i]);
+        const State f5 = dy_dr(r + 8.0 / 9.0 * dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++)
+            y_stage[i] = y[i] + dr * (9017.0 / 3168.0 * f1[i] - 355.0 / 33.0 * f2[i] + 46732.0 / 5247.0 * f3[i] + 49.0 / 176.0 * f4[i] - 5103.0 / 18656.0 * f5[i]);
+        const State f6 = dy_dr(r + dr, y_stage, params);
+        for(unsigned int i = 0; i < n; i++)   // 5th order accurate step
+            y_new[i] = y[i] + dr * (35.0 / 384.0 * f1[i] + 500.0 / 1113.0 * f3[i] + 125.0 / 192.0 * f4[i] - 2187.0 / 6784.0 * f5[i] + 11.0 / 84.0 * f6[i]);
+        const State f7 = dy_dr(r + dr, y_new, params);
+
+        // difference between the 5th and 4th order accurate steps (inf-Norm), scaled as in RKF45_step:
+        double truncation_error = 0.;
+        for(unsigned int i = 0; i < n; i++)
+            truncation_error = std::max(truncation_error, std::abs(dr * (71.0 / 57600.0 * f1[i] - 71.0 / 16695.0 * f3[i] + 71.0 / 1920.0 * f4[i]
+                                                                        - 17253.0 / 339200.0 * f5[i] + 22.0 / 525.0 * f6[i] - 1.0 / 40.0 * f7[i])));
+
+        if( State::is_nan(y_new) || std::isnan(truncation_error)) {
+            dr *= 0.5;
+            if (dr < options.min_stepsize) {
+                if(options.verbose > 0)
+                    std::cout << "Nan found" << y_new << f1 << f2 << f3 << f4 << f5 << f6 << f7 << "\n  for r=" << r << ", dr=" << dr <<  std::endl;
+                throw std::runtime_error("NaN detected");
+            }
+            if(options.verbose > 3)
+                std::cout << "step not precise enough and stepsize decreased creased: dr = " << dr << std::endl;
+            continue;
+        }
+
+        if (options.force_max_stepsize) {	// note: this will ignore target truncation error
+            r += dr;
+            y = y_new;
+            dy = f7;
+            dr = options.max_stepsize;
+            return true;
+        }
+
+        // approximating the truncation error:
+        truncation_error *= dr;
+
+        if (truncation_error > options.target_error) {
+            const double dr_taken = dr;
+            dr *= controller.reject(truncation_error/options.target_error);     // truncation error is too large. We repeat the iteration with smaller stepsize
+
+            if (dr < options.min_stepsize) {
+                // error is not acceptable but the stepsize cannot get any smaller:
+                // write new values for r and the evolved quantities
+                r += dr_taken;
+                y = y_new;
+                dy = f7;
+
+                dr = options.min_stepsize; // ensure that the stepsize never gets too small
+                if(options.verbose > 0) {
+                    std::cout << "Error in DoPri5_step(): Minimal stepsize underflow at r = " << r << ", dr = "<< dr << std::endl;  // error message for debugging
+                    std::cout << "Truncation error = "<< truncation_error << std::endl;
+                    std::cout << y << std::endl;
+                }
+                return false;
+            }
+
+            if(options.verbose > 3)
+                std::cout << "step not precise enough and stepsize decreased creased: dr = " << dr << std::endl;
+            continue;
+        }
+        else {
+            // error is small enough and therefore we can use this step. To save computation time, we then increase the stepsize
+            r += dr;
+            y = y_new;
+            dy = f7;
+
+            dr *= controller.accept(truncation_error/options.target_error);
+            if (dr > options.max_stepsize)
+                dr = options.max_stepsize;   // enforce maximal stepsize
+
+            if(options.verbose > 3){
+                std::cout << "step accepted and stepsize adjusted: dr = " << dr << std::endl;
+            }
+            return true;
+        }
+    }
+}
+
+/* The dense output is the cubic Hermite polynomial through y0, y1 with the derivatives dy0, dy1, which are known from the steppers
+ * The interpolation error is of order (r1-r0)^4 */
+template <typename State>
+void integrator::dense_output(const double r0, const State& y0, const State& dy0, const double r1, const State& y1, const State& dy1,
+                                            const double r, State& y, State& dy)
+{
+    const double h = r1 - r0, t = (r - r0)/h;
+    const double h00 = (1. + 2.*t)*(1. - t)*(1. - t), h10 = t*(1. - t)*(1. - t), h01 = t*t*(3. - 2.*t), h11 = t*t*(t - 1.);
+    const double dh00 = 6.*t*(t - 1.), dh10 = (1. - t)*(1. - 3.*t), dh11 = t*(3.*t - 2.);
+    for(unsigned int i = 0; i < y0.size(); i++) {
+        y[i] = h00*y0[i] + h*h10*dy0[i] + h01*y1[i] + h*h11*dy1[i];
+        dy[i] = dh00/h*(y0[i] - y1[i]) + dh10*dy0[i] + dh11*dy1[i];
+    }
+}
+
+/* The event condition is false at r0 and true at r1. The crossing is found by bisection on the dense output of the step,
+ * no further evaluations of dy_dr are needed
+ * Returns the smallest r found where the condition is true, which is at most event.target_accuracy after the crossing */
+template <typename State>
+double integrator::locate_event(const Event& event, const double r0, const State& y0, const State& dy0, const double r1, const State& y1, const State& dy1, const void* params)
+{
+    double r_l = r0, r_r = r1;
+    State y(y0), dy(dy0);
+    vector y_buffer, dy_buffer;
+    while(r_r - r_l > event.target_accuracy) {
+        const double r_mid = (r_l + r_r)/2.;
+        dense_output(r0, y0, dy0, r1, y1, dy1, r_mid, y, dy);
+        if(event.condition(r_mid, r_mid - r0, as_vector(y, y_buffer), as_vector(dy, dy_buffer), params))
+            r_r = r_mid;
+        else
+            r_l = r_mid;
+    }
+    return r_r;
+}
+
+/* After every step the events with a target_accuracy that would turn active are located on the dense output of the step
+ * If the crossing lies before the end of the step, the step is repeated once with the stepsize chosen to end right at the crossing,
+ * so that the integration has a step within target_accuracy after the crossing
+ * The stepsize proposed by the controller for the original step is kept for the next step */
+template <typename State, typename RHS>
+int integrator::RKF45_step_event_tester(const RHS& dy_dr, std::pair<double, State>& current_step, State& dy, double& step_size, const void* params,
+                                            const std::vector<Event>& events, const IntegrationOptions& options, StepController& controller) {
+
+    double r;
+    double dr;
+    State y(current_step.second), dy_new(dy);
+    vector y_buffer, dy_buffer; // only used for fixed_vector States, allocated once
+    bool step_success = false, landing = false;
+    double step_size_next = step_size;
+
+    while(true) {
+        r = current_step.first;
+        y = current_step.second;
+        if(options.method == dopri5) {
+            dy_new = dy;
+            step_success = DoPri5_step(dy_dr, r, step_size, y, dy_new, params, options, controller);
+        }
+        else {
+            step_success = RKF45_step(dy_dr, r, step_size, y, dy, params, options, controller);
+            dy_new = dy_dr(r, y, params);
+        }
+        if (!step_success || landing) // if this step fails already, return
+            break;
+
+        dr = r - current_step.first;
+        double r_event = r;     // the earliest crossing of the events that require a higher accuracy
+        // iterate through all defined events and check if they would turn active
+        for(auto it = events.begin(); it != events.end(); ++it) {
+            if ( it->active || it->target_accuracy <= 0.)
+                continue;
+
+            if(it->condition(r, dr, as_vector(y, y_buffer), as_vector(dy_new, dy_buffer), params)) {
+                if ( dr > it->target_accuracy*1.001 ) { // do these require higher accuracy?
+                    const double r_crossing = locate_event(*it, current_step.first, current_step.second, dy, r, y, dy_new, params);
+                    r_event = std::min(r_event, r_crossing);
+                    if (options.verbose > 1)
+                        std::cout << "event " << it->name << " required higher accuracy at r = " << r << " where stepsize = " << dr << " and was located at r = " << r_crossing << std::endl;
+                }
+            }
+        }
+        if (r_event >= r) // none would be active or target accuracy is achieved
+            break;
+
+        // repeat the step to end at the crossing
+        step_size_next = step_size;
+        step_size = std::max(r_event - current_step.first, options.min_stepsize);
+        landing = true;
+    }
+    if (landing)
+        step_size = step_size_next;
+    current_step.first = r;
+    current_step.second = y;
+    dy = dy_new;
+
+    return step_success;
+}
+
+/* The starting stepsize is estimated from the norms of y0, dy0 and the change of the derivative after a small explicit Euler step
+ * The norms are the maximum norms scaled by options.target_error, as in the truncation error of the steppers */
+template <typename State, typename RHS>
+double integrator::initial_stepsize(const RHS& dy_dr, const double r0, const State& y0, const State& dy0, const void* params, const IntegrationOptions& options)
+{
+    const unsigned int n = y0.size();
+    double d0 = 0., d1 = 0.;
+    for(unsigned int i = 0; i < n; i++) {
+        d0 = std::max(d0, std::abs(y0[i]));
+        d1 = std::max(d1, std::abs(dy0[i]));
+    }
+    d0 /= options.target_error; d1 /= options.target_error;
+    double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0/d1;
+    h0 = std::min(h0, options.max_stepsize);
+
+    // explicit Euler step to estimate the second derivative
+    State y1(y0);
+    for(unsigned int i = 0; i < n; i++)
+        y1[i] = y0[i] + h0 * dy0[i];
+    const State dy1 = dy_dr(r0 + h0, y1, params);
+    double d2 = 0.;
+    for(unsigned int i = 0; i < n; i++)
+        d2 = std::max(d2, std::abs(dy1[i] - dy0[i]));
+    d2 /= options.target_error * h0;
+
+    double h1;
+    if(std::isnan(d2) || std::max(d1, d2) <= 1e-15)
+        h1 = std::max(1e-6, h0 * 1e-3);
+    else
+        h1 = std::pow(0.01 / std::max(d1, d2), 1./6.);  // the truncation error scales as dr^6, see StepController
+
+    return std::max(options.min_stepsize, std::min(std::min(100. * h0, h1), options.max_stepsize));
+}
+
+/* This function integrates an ODE system according to the RKF45 or Dormand-Prince algorithm (see options.method)
+ *
+ * The system is described by dy_dr, the integration starts at r0 and tries to reach r_end
+ * The initial values are given by y0. The params pointer can be arbitrary and is passed on to dy_dr
+ * The last step is saved in results (all steps if options.save_intermediate == true)
+ * and any number of events can be tracked throughout the evolution with the events vector
+ * The memory of results is kept, so reusing a Trajectory for several integrations avoids reallocations
+ * The observer is called for every step, independently of options.save_intermediate */
+template <typename State, typename RHS>
+int integrator::RKF45(const RHS& dy_dr, const double r0, const State& y0, const double r_end, const void* params,
+                            Trajectory& results, std::vector<Event>& events, const IntegrationOptions& options, Observer* observer)
+{
+    std::pair<double, State> current_step = std::make_pair(r0, y0);
+    State dy = dy_dr(r0, y0, params);       // the derivative at the current step, updated by the stepper
+    double step_size = options.force_max_stepsize ? options.max_stepsize : initial_stepsize(dy_dr, r0, y0, dy, params, options);
+    StepController controller;
+    vector y_buffer, dy_buffer;     // the events expect FBS::vector, for fixed_vector States these are filled without reallocation
+
+    // clear passed arguments
+    results.clear();
+    if(options.clean_events) {
+        for(auto it = events.begin(); it != events.end(); ++it)
+            it->reset();
+    }
+
+    if(options.save_intermediate)
+        results.push_back(r0, y0);
+    if(observer)
+        observer->observe(r0, as_vector(y0, y_buffer), as_vector(dy, dy_buffer));
+
+    if(options.verbose > 0)
+        std::cout << "starting integration at r=" << current_step.first << std::endl;
+
+    // begin integration
+    int i = 0, stop = 0;
+    while(true) {
+
+        bool step_success = RKF45_step_event_tester(dy_dr, current_step, dy, step_size, params, events,  options, controller);
+        if(options.verbose > 2)
+            std::cout  << "rkf45 step: r=" <<  current_step.first << ", dr= " << step_size << ", y=" << current_step.second << ", dy=" << dy <<  std::endl;
+
+        if(options.save_intermediate)
+            results.push_back(current_step.first, current_step.second);
+
+        // iterate through all defined events and check them (happens every iteration step)
+        const vector& y_event = as_vector(current_step.second, y_buffer);
+        const vector& dy_event = as_vector(dy, dy_buffer);
+        if(observer)
+            observer->observe(current_step.first, y_event, dy_event);
+        for(auto it = events.begin(); it != events.end(); ++it) {
+            if(it->condition(current_step.first, step_size, y_event, dy_event, params)) {
+                if(!it->active) {   // these events only trigger when the condition wasn't previously active
+                    it->active = true;
+                    it->steps.push_back(std::make_pair(current_step.first, y_event));  // add the current values of the ODE vars to the event object
+                    if(it->stopping_condition) {     // if the event is defined as a stopping condition, we stop the iteration (see below)
+                        stop = event_stopping_condition;
+                        if(options.verbose > 0)
+                            std::cout << "stopping condition: " << it->name << " triggered - ";
+                    }
+                }
+            } else
+                it->active = false;
+        }
+
+        // check additional stopping conditions
+        if(current_step.first > r_end)     // max r reached
+            stop = endpoint_reached;
+        if(i > options.max_step)            // max number of steps reached
+            stop = iteration_number_exceeded;
+        if(!step_success)                   // problem in the last step (e.g. stepsize too small and/or truncation error too large)
+            stop = stepsize_underflow;
+        if(stop) {
+            if(!options.save_intermediate)  // save the last step if not already done
+                results.push_back(current_step.first, current_step.second);
+            if(options.verbose > 0)
+                std::cout << "stopped integration with code " << stop << " at r=" << current_step.first << std::endl;
+            return stop;    // exit the integrator if a stopping condition was reached
+        }
+        i++;
+    }
 }
 
 }
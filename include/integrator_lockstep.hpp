@@ -0,0 +1,301 @@
+#pragma once
+
+#include <vector>   // for std::vector
+#include <stdexcept> // for std::runtime_error
+#include <algorithm> // for std::max
+#include <cmath>     // for std::abs
+
+#include "vector.hpp"
+#include "integrator.hpp"
+
+namespace FBS {
+
+namespace integrator
+{
+    /* The number of integrations that lockstep_DoPri5 advances together,
+     *  the number of doubles in a SIMD register with AVX-512 and twice that with AVX2 otherwise
+     * The stages are vectorized only if the code is compiled for these instruction sets (see NATIVE in the Makefile) */
+#if defined(__AVX512F__)
+    constexpr std::size_t lockstep_lanes = 8;
+#else
+    constexpr std::size_t lockstep_lanes = 4;
+#endif
+
+    /* Lane
+     * describes the integration in one lane of lockstep_DoPri5, the values of the lanes are stored separately by component
+     * These are set by the system when the lane is filled:
+     *  id          : identifies the integration for the system, e.g. the index of the star
+     *  r_end       : the integration stops after r_end
+     *  params      : passed to the right hand side and the event conditions, as in RKF45
+     *  events      : the events of this integration (may be null), reset at the start if options.clean_events
+     *  observer    : called on every step as in RKF45 (may be null)
+     * The others are the state of the stepsize control between the steps */
+    template <std::size_t N>
+    struct Lane {
+        unsigned int id;
+        double r_end;
+        const void* params;
+        std::vector<Event>* events;
+        Observer* observer;
+
+        bool active;            // whether the lane holds an integration
+        StepController controller;
+        bool landing;           // whether the step is repeated to end at the crossing of an event, see RKF45_step_event_tester
+        double step_size_next;  // the stepsize after the landing
+        int steps;
+    };
+
+    /* Integrates many independent initial value problems with the same equations, L of them at the same time:
+     *  every lane holds one integration, the values of all lanes are stored by component, and every stage of the
+     *  Dormand-Prince stepper is computed for all lanes at once, so that the compiler can vectorize it over the lanes.
+     * Every lane has its own stepsize and step controller, a lane whose step is rejected repeats it in the next stage
+     *  of the others. When an integration stops, its lane is filled with the next one from the system, until there is none left
+     * The steps of every lane are the same as those of RKF45 with options.method == dopri5 for that integration:
+     *  the events with a target_accuracy are located in the same way and the stopping conditions are the same.
+     *  The steps are only passed to the observer of the lane, options.save_intermediate and options.verbose are ignored
+     *
+     * The system provides
+     *  bool next(const unsigned int l, Lane<N>& lane, double& r0, fixed_vector<N>& y0)
+     *          : sets id, r_end, params, events and observer of the next integration and its initial values for the lane l,
+     *            returns false if there is none left
+     *  void finish(const unsigned int l, const Lane<N>& lane, const double r, const fixed_vector<N>& y, const int reason)
+     *          : is called with the last step and the return_reason when the integration in lane l stops
+     *  fixed_vector<N> operator()(const double r, const fixed_vector<N>& y, const void* params)
+     *          : the equations for a single point, used for the initial derivative and stepsize
+     *  void dy_dr_lanes(const double (&r)[L], const double (&y)[N][L], double (&dy)[N][L])
+     *          : the same equations for all lanes. Lanes that don't hold an integration anymore keep their last values
+     *            and are computed as well, their results are ignored */
+    template <std::size_t N, std::size_t L, typename System>
+    void lockstep_DoPri5(System& system, const IntegrationOptions& options);
+
+}
+
+/* Template functions must be defined in the header file: */
+
+template <std::size_t N, std::size_t L, typename System>
+void integrator::lockstep_DoPri5(System& system, const IntegrationOptions& options)
+{
+    Lane<N> lanes[L];
+    // the values of the lanes by component, f[0] is the derivative at the current step (FSAL, see DoPri5_step)
+    alignas(64) double r[L], dr[L], r_stage[L], truncation_error[L];
+    alignas(64) double y[N][L], y_stage[N][L], y_new[N][L], f[7][N][L];
+    vector y_buffer, dy_buffer;     // the events and observers expect FBS::vector
+
+    // fills lane l with the next integration, as at the start of RKF45
+    auto fill = [&](const unsigned int l) {
+        Lane<N>& lane = lanes[l];
+        double r0;
+        fixed_vector<N> y0;
+        lane.active = system.next(l, lane, r0, y0);
+        if(!lane.active)
+            return;
+        const fixed_vector<N> dy0 = system(r0, y0, lane.params);
+        dr[l] = options.force_max_stepsize ? options.max_stepsize : initial_stepsize(system, r0, y0, dy0, lane.params, options);
+        lane.controller = StepController();
+        lane.landing = false;
+        lane.steps = 0;
+        if(options.clean_events && lane.events) {
+            for(auto it = lane.events->begin(); it != lane.events->end(); ++it)
+                it->reset();
+        }
+        r[l] = r0;
+        for(unsigned int i = 0; i < N; i++) {
+            y[i][l] = y0[i];
+            f[0][i][l] = dy0[i];
+        }
+        if(lane.observer)
+            lane.observer->observe(r0, as_vector(y0, y_buffer), as_vector(dy0, dy_buffer));
+    };
+
+    for(unsigned int l = 0; l < L; l++)
+        fill(l);
+
+    while(true) {
+        bool any_active = false;
+        for(unsigned int l = 0; l < L; l++)
+            any_active = any_active || lanes[l].active;
+        if(!any_active)
+            return;
+
+        // the sums are written out as in DoPri5_step, so that the lanes give the same values as the integrator for one point
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            r_stage[l] = r[l] + 1.0 / 5.0 * dr[l];
+        for(unsigned int i = 0; i < N; i++) {
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                y_stage[i][l] = y[i][l] + dr[l] * (1.0 / 5.0 * f[0][i][l]);
+        }
+        system.dy_dr_lanes(r_stage, y_stage, f[1]);
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            r_stage[l] = r[l] + 3.0 / 10.0 * dr[l];
+        for(unsigned int i = 0; i < N; i++) {
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                y_stage[i][l] = y[i][l] + dr[l] * (3.0 / 40.0 * f[0][i][l] + 9.0 / 40.0 * f[1][i][l]);
+        }
+        system.dy_dr_lanes(r_stage, y_stage, f[2]);
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            r_stage[l] = r[l] + 4.0 / 5.0 * dr[l];
+        for(unsigned int i = 0; i < N; i++) {
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                y_stage[i][l] = y[i][l] + dr[l] * (44.0 / 45.0 * f[0][i][l] - 56.0 / 15.0 * f[1][i][l] + 32.0 / 9.0 * f[2][i][l]);
+        }
+        system.dy_dr_lanes(r_stage, y_stage, f[3]);
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            r_stage[l] = r[l] + 8.0 / 9.0 * dr[l];
+        for(unsigned int i = 0; i < N; i++) {
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                y_stage[i][l] = y[i][l] + dr[l] * (19372.0 / 6561.0 * f[0][i][l] - 25360.0 / 2187.0 * f[1][i][l] + 64448.0 / 6561.0 * f[2][i][l] - 212.0 / 729.0 * f[3][i][l]);
+        }
+        system.dy_dr_lanes(r_stage, y_stage, f[4]);
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            r_stage[l] = r[l] + dr[l];
+        for(unsigned int i = 0; i < N; i++) {
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                y_stage[i][l] = y[i][l] + dr[l] * (9017.0 / 3168.0 * f[0][i][l] - 355.0 / 33.0 * f[1][i][l] + 46732.0 / 5247.0 * f[2][i][l] + 49.0 / 176.0 * f[3][i][l] - 5103.0 / 18656.0 * f[4][i][l]);
+        }
+        system.dy_dr_lanes(r_stage, y_stage, f[5]);
+        for(unsigned int i = 0; i < N; i++) {   // 5th order accurate step
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                y_new[i][l] = y[i][l] + dr[l] * (35.0 / 384.0 * f[0][i][l] + 500.0 / 1113.0 * f[2][i][l] + 125.0 / 192.0 * f[3][i][l] - 2187.0 / 6784.0 * f[4][i][l] + 11.0 / 84.0 * f[5][i][l]);
+        }
+        system.dy_dr_lanes(r_stage, y_new, f[6]);
+
+        // difference between the 5th and 4th order accurate steps (inf-Norm), as in DoPri5_step
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            truncation_error[l] = 0.;
+        for(unsigned int i = 0; i < N; i++) {
+            #pragma omp simd
+            for(unsigned int l = 0; l < L; l++)
+                truncation_error[l] = std::max(truncation_error[l], std::abs(dr[l] * (71.0 / 57600.0 * f[0][i][l] - 71.0 / 16695.0 * f[2][i][l] + 71.0 / 1920.0 * f[3][i][l]
+                                                                        - 17253.0 / 339200.0 * f[4][i][l] + 22.0 / 525.0 * f[5][i][l] - 1.0 / 40.0 * f[6][i][l])));
+        }
+
+        // the stepsize control of DoPri5_step and the event handling of RKF45_step_event_tester and RKF45 for every lane
+        for(unsigned int l = 0; l < L; l++) {
+            Lane<N>& lane = lanes[l];
+            if(!lane.active)
+                continue;
+
+            bool is_nan = std::isnan(truncation_error[l]);
+            for(unsigned int i = 0; i < N; i++)
+                is_nan = is_nan || std::isnan(y_new[i][l]);
+            if(is_nan) {
+                dr[l] *= 0.5;
+                if (dr[l] < options.min_stepsize)
+                    throw std::runtime_error("NaN detected");
+                continue;
+            }
+
+            double r_new;
+            bool step_success = true;
+            if(options.force_max_stepsize) {	// note: this will ignore target truncation error
+                r_new = r[l] + dr[l];
+                dr[l] = options.max_stepsize;
+            }
+            else {
+                const double error = truncation_error[l] * dr[l];
+                if (error > options.target_error) {
+                    const double dr_taken = dr[l];
+                    dr[l] *= lane.controller.reject(error/options.target_error);
+                    if (dr[l] >= options.min_stepsize)
+                        continue;   // the step is repeated with the smaller stepsize
+                    // the stepsize cannot get any smaller, the step is taken anyway
+                    r_new = r[l] + dr_taken;
+                    dr[l] = options.min_stepsize;
+                    step_success = false;
+                }
+                else {
+                    r_new = r[l] + dr[l];
+                    dr[l] *= lane.controller.accept(error/options.target_error);
+                    if (dr[l] > options.max_stepsize)
+                        dr[l] = options.max_stepsize;
+                }
+            }
+
+            fixed_vector<N> y_step, dy_step;
+            for(unsigned int i = 0; i < N; i++) {
+                y_step[i] = y_new[i][l];
+                dy_step[i] = f[6][i][l];
+            }
+
+            // the events that require a higher accuracy, the step is repeated to end at the earliest crossing
+            if(step_success && !lane.landing && lane.events) {
+                const double dr_step = r_new - r[l];
+                double r_event = r_new;
+                for(auto it = lane.events->begin(); it != lane.events->end(); ++it) {
+                    if ( it->active || it->target_accuracy <= 0.)
+                        continue;
+                    if(it->condition(r_new, dr_step, as_vector(y_step, y_buffer), as_vector(dy_step, dy_buffer), lane.params) && dr_step > it->target_accuracy*1.001) {
+                        fixed_vector<N> y_prev, dy_prev;
+                        for(unsigned int i = 0; i < N; i++) {
+                            y_prev[i] = y[i][l];
+                            dy_prev[i] = f[0][i][l];
+                        }
+                        r_event = std::min(r_event, locate_event(*it, r[l], y_prev, dy_prev, r_new, y_step, dy_step, lane.params));
+                    }
+                }
+                if (r_event < r_new) {
+                    lane.step_size_next = dr[l];
+                    dr[l] = std::max(r_event - r[l], options.min_stepsize);
+                    lane.landing = true;
+                    continue;
+                }
+            }
+            if(lane.landing) {
+                dr[l] = lane.step_size_next;
+                lane.landing = false;
+            }
+
+            r[l] = r_new;
+            for(unsigned int i = 0; i < N; i++) {
+                y[i][l] = y_step[i];
+                f[0][i][l] = dy_step[i];
+            }
+
+            // the step is done, the observer and the events are called as in RKF45
+            const vector& y_event = as_vector(y_step, y_buffer);
+            const vector& dy_event = as_vector(dy_step, dy_buffer);
+            if(lane.observer)
+                lane.observer->observe(r_new, y_event, dy_event);
+            int stop = 0;
+            if(lane.events) {
+                for(auto it = lane.events->begin(); it != lane.events->end(); ++it) {
+                    if(it->condition(r_new, dr[l], y_event, dy_event, lane.params)) {
+                        if(!it->active) {
+                            it->active = true;
+                            it->steps.push_back(std::make_pair(r_new, y_event));
+                            if(it->stopping_condition)
+                                stop = event_stopping_condition;
+                        }
+                    } else
+                        it->active = false;
+                }
+            }
+            if(r_new > lane.r_end)
+                stop = endpoint_reached;
+            if(lane.steps > options.max_step)
+                stop = iteration_number_exceeded;
+            if(!step_success)
+                stop = stepsize_underflow;
+            if(stop) {
+                system.finish(l, lane, r_new, y_step, stop);
+                fill(l);
+                continue;
+            }
+            lane.steps++;
+        }
+    }
+}
+
+}
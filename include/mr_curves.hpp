@@ -7,10 +7,14 @@
 #include <fstream>	// file streams
 #include <memory>
 #include <chrono>   // for timing functionalities
+#include <cstdint>  // for the hash of the EoS in the names of the cost models
 #include <omp.h>
 
 #include "vector.hpp"    // include custom 5-vector class
 #include "integrator.hpp"
+#include "workspace.hpp"   // the thread-local workspaces that are handed to the stars
+#include "executor.hpp"    // the worker threads that evaluate the stars of all curves
+#include "cost_model.hpp"  // the predicted cost of the stars, the most expensive are started first
 #include "eos.hpp" // include eos container class
 #include "nsmodel.hpp"
 #include "fbs_twofluid.hpp"
@@ -48,21 +52,34 @@ void write_MRphi_curve(const std::vector<T>& MRphi_curve, std::string filename)
 	img.close();
 }
 
+/* The search for omega uses the omega_solver of the given stars */
 void calc_rhophi_curves(std::vector<FermionBosonStar>& MRphi_curve, int verbose=1);
-void calc_rhophi_curves(double mu, double lambda, std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid, const std::vector<double>& phi_c_grid, std::vector<FermionBosonStar>& MRphi_curve, int verbose=1);
+/* With continuation, the grid is walked along lines of constant phi_c (or rho_c, if there are more of those lines), and omega of every
+ * star is extrapolated from the solved neighbours on the line, so that FermionBosonStar::bisection_warm_start starts with a narrow range.
+ * omega_solver is the method of the last stage of the search for omega, see FermionBosonStar::omega_solver */
+void calc_rhophi_curves(double mu, double lambda, std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid, const std::vector<double>& phi_c_grid, std::vector<FermionBosonStar>& MRphi_curve, int verbose=1, bool continuation=false,
+                            FermionBosonStar::omega_solver_method omega_solver=FermionBosonStar::sign_bisection);
 
 void calc_NbNf_curves(double mu, double lambda, std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid, const std::vector<double>& NbNf_grid, std::vector<FermionBosonStar>& MRphi_curve);
 
-void calc_MRphik2_curve(const std::vector<FermionBosonStar>& MRphi_curve,  std::vector<FermionBosonStarTLN>& MRphik2_curve, int verbose=1);
+/* With superposition, phi_1_0 of every star is found with FermionBosonStarTLN::superposition_phi_1 from a single integration
+ * instead of FermionBosonStarTLN::bisection_phi_1
+ * With reuse_background, the background of every star is integrated once and the integrations only integrate the perturbations,
+ *  forced by this background, see FermionBosonStarTLN::set_background */
+void calc_MRphik2_curve(const std::vector<FermionBosonStar>& MRphi_curve,  std::vector<FermionBosonStarTLN>& MRphik2_curve, int verbose=1, bool superposition=false, bool reuse_background=false);
 
 void calc_twofluidFBS_curves(std::shared_ptr<EquationOfState> EOS1, std::shared_ptr<EquationOfState> EOS2, const std::vector<double>& rho1_c_grid, const std::vector<double>& rho2_c_grid, std::vector<TwoFluidFBS>& MRphi_curve, double mu=1, double lambda=1);
 
 // ---------------------
 
-void calc_EinsteinCartan_curves(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, double beta, double gamma, int verbose = 1);
-void calc_EinsteinCartan_curves_beta_grid(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma = 2., int verbose = 1);
+/* With lockstep, the stars are integrated with NSEinsteinCartan::evaluate_models, several stars at a time on every thread.
+ * That uses the Dormand-Prince stepper, so the results agree with the default to the integration accuracy */
+void calc_EinsteinCartan_curves(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, double beta, double gamma, int verbose = 1, bool lockstep = false);
+void calc_EinsteinCartan_curves_beta_grid(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma = 2., int verbose = 1, bool lockstep = false);
 void calc_EinsteinCartan_curves_rotation_beta_grid(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartanRotation>& MR_curve, const std::vector<double>& beta_grid, int verbose = 1);
 
-void calc_EinsteinCartan_curves_const_mass(std::shared_ptr<EquationOfState> EOS, double rho_c_init,std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma, double wanted_mass, std::string quantity_label, int verbose = 1);
+/* With continuation, the beta grid is walked in order (in a few segments for the workers), and rho_0 of every star is extrapolated
+ * from the solved neighbours, so that NSEinsteinCartan::shooting_constant_Mass_warm_start starts with a narrow range */
+void calc_EinsteinCartan_curves_const_mass(std::shared_ptr<EquationOfState> EOS, double rho_c_init,std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma, double wanted_mass, std::string quantity_label, int verbose = 1, bool continuation = false);
 
 }
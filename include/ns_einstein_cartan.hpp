@@ -1,19 +1,60 @@
 #pragma once
 
 #include <utility>  // for std::swap
+#include <atomic>   // for the list of stars shared by the threads in evaluate_models
+#include <limits>   // for the machine epsilon in shooting_constant_Mass_warm_start
 
 #include "vector.hpp"
 #include "eos.hpp"
 #include "integrator.hpp"
 #include "nsmodel.hpp"
+#include "integrator_lockstep.hpp"
+#include "utilities.hpp"  // for brent_zeroin in shooting_constant_Mass_warm_start
 
 namespace FBS {
 
+/* NSEinsteinCartanObserver
+ * computes the star parameters M_T, R_NS, R_99 and M_rest of the Einstein Cartan models step by step during the integration,
+ *  so that the steps do not have to be saved
+ * The rest mass is integrated with the trapezoidal rule over the steps. For R_99 only the steps in the outer 1% of the rest mass
+ *  are kept, as the rest mass only increases. They are kept in a vector that can be given by the caller, e.g. an array of a Workspace,
+ *  so that its memory is reused for the following stars and no memory is allocated once it has grown to the largest outer shell
+ * The values are valid after finalize() has been called */
+class NSEinsteinCartanObserver : public integrator::Observer {
+public:
+    double M_T, R_NS, R_99, M_rest;
+    bool surface_found;     // whether R_NS was found, i.e. P dropped below the minimum pressure
+
+    NSEinsteinCartanObserver(std::shared_ptr<EquationOfState> EOS, std::vector<double>* buffer=nullptr) : EOS(EOS), buffer(buffer) { this->reset(); }
+
+    void reset();
+    void observe(const double r, const vector& y, const vector& dy);
+    /* The same for a step with the metric component a, the pressure P and the restmass density rho at P,
+     *  e.g. from EquationOfState::callEOS_batch for all steps of a trajectory */
+    void observe(const double r, const double a, const double P, const double rho);
+    void finalize();
+
+private:
+    std::shared_ptr<EquationOfState> EOS;
+    int steps;
+    double r_last, a_last, N_F_integrand_last;
+    // r and the rest mass contained within r of the steps, the outer shell starts at the pair first, the pairs before are removed from time to time
+    std::vector<double>* buffer;
+    std::vector<double> own_buffer;     // if no buffer is given
+    std::size_t first;
+    std::vector<double>& outer_shell() { return buffer ? *buffer : own_buffer; }
+};
+
 // this is a class modeling a neutron star in Eistein Cartan gravity
 // constructor: EOS (ptr), EOS2 (ptr)
 class NSEinsteinCartan : public NSmodel {
 protected:
-    void calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events);
+    void calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events);
+    /* copies the star parameters computed by the observer */
+    void set_star_parameters(const NSEinsteinCartanObserver& observer);
+    /* The stars of evaluate_models as the system for integrator::lockstep_DoPri5, with the EoS of type E */
+    template <typename E>
+    class Lanes;
 
 public:
 
@@ -21,21 +62,44 @@ public:
     double rho_0;	// initial condition, central density of the NS fluid
     double M_T, R_NS, R_99; // total mass M_T; radius of neutron star where pressure is zero R_NS; radius where 99% of restmass is included R_99 
 	double M_rest, C; // total restmass of the NS fluid; compactness C:=M/R
+    int shooting_iterations;    // number of evaluations of the last search for rho_0 in shooting_constant_Mass, for comparing the methods
 
 
 	NSEinsteinCartan(std::shared_ptr<EquationOfState> EOS, double rho_0_in, double beta_in, double gamma_in)
-        : NSmodel(EOS), beta(beta_in), gamma(gamma_in), rho_0(rho_0_in), M_T(0.), R_NS(0.), R_99(0.), M_rest(0.), C(0.) {}
+        : NSmodel(EOS), beta(beta_in), gamma(gamma_in), rho_0(rho_0_in), M_T(0.), R_NS(0.), R_99(0.), M_rest(0.), C(0.), shooting_iterations(0) {}
 
     //vector dy_dr(const double r, const vector& vars);  // holds the system of ODEs
 	/* The differential equations describing the neutron star in Einstein Cartan gravity. The quantities are a, alpha, P */
     vector dy_dr(const double r, const vector& vars) const;
+    /* The same equations for the fixed-dimension integrator, which does not allocate memory during the integration */
+    virtual fixed_vector<3> dy_dr(const double r, const fixed_vector<3>& vars) const;
+    /* The same equations with the EoS of type E, the calls to the EoS are not virtual if E is a concrete EoS (see dispatch_eos) */
+    template <typename E>
+    fixed_vector<3> dy_dr(const double r, const fixed_vector<3>& vars, E& myEOS) const;
+
+    /* Calls the fixed-dimension integrator for the 3 variables a, alpha, P, instantiated for the concrete type of the EoS */
+    int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
 
     vector get_initial_conditions(const double r_init=R_INIT) const; // holds the FBS init conditions
-    void evaluate_model(std::vector<integrator::step>& results, std::string filename="");
+    void evaluate_model(integrator::Trajectory& results, std::string filename="");
     void evaluate_model();
+    /* the trajectory, events and the outer shell of the observer are taken from the workspace (trajectory slot 0, array slot 0),
+     *  which can be reused for the next star */
+    void evaluate_model(Workspace& workspace);
+    /* Evaluates the stars with integrator::lockstep_DoPri5, which integrates integrator::lockstep_lanes of them at the same time
+     * The stars are taken from the list by the counter next, so several threads can work on the same list with a shared counter.
+     * The steps are those of the Dormand-Prince stepper (integrator::dopri5), so the results agree with evaluate_model(), which uses RKF45,
+     *  to the integration accuracy. Stars with another EoS than the first one are evaluated with it */
+    static void evaluate_models(std::vector<NSEinsteinCartan>& stars, std::atomic<unsigned int>& next);
 
     // optimizes the central density to find a star with a specific mass
     void shooting_constant_Mass(double wanted_mass, std::string quantity_label, double accuracy=1e-6, int max_steps=200);
+    /* The same, but starts from a guess for rho_0, e.g. extrapolated from the star at the neighbouring beta, with the range rho_0_guess*(1 -+ rel_width).
+     * The range is moved until the mass increases through wanted_mass in it, then rho_0 is found with Brent's method on the mass.
+     * If no such range is found, the search starts over with shooting_constant_Mass */
+    void shooting_constant_Mass_warm_start(double wanted_mass, std::string quantity_label, double rho_0_guess, double rel_width, double accuracy=1e-6, int max_steps=200);
+    /* The highest central density, where 8pi*beta*gamma*P^(gamma-1) = 1, or 10 if beta = 0 */
+    double max_possible_density() const;
 
     friend std::ostream& operator<<(std::ostream&, const NSEinsteinCartan&);
     static std::vector<std::string> labels();
@@ -43,6 +107,7 @@ public:
 
     static const integrator::Event Pressure_zero;
     static const integrator::Event Pressure_diverging;
+    static const integrator::Event P_min_reached;
 };
 
 std::ostream& operator<<(std::ostream&, const NSEinsteinCartan&);
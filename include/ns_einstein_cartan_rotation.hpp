@@ -14,7 +14,8 @@ namespace FBS {
 // constructor: EOS (ptr), EOS2 (ptr)
 class NSEinsteinCartanRotation : public NSEinsteinCartan {
 protected:
-    void calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events);
+    void calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events);
+    void set_star_parameters(const NSEinsteinCartanObserver& observer);
 
 public:
 
@@ -29,10 +30,18 @@ public:
     //vector dy_dr(const double r, const vector& vars);  // holds the system of ODEs
 	/* The differential equations describing the neutron star in Einstein Cartan gravity. The quantities are a, alpha, P */
     vector dy_dr(const double r, const vector& vars) const;
+    fixed_vector<3> dy_dr(const double r, const fixed_vector<3>& vars) const;
+    template <typename E>
+    fixed_vector<3> dy_dr(const double r, const fixed_vector<3>& vars, E& myEOS) const;
+    /* Calls the fixed-dimension integrator with the equations of this class, instantiated for the concrete type of the EoS */
+    int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
     vector get_initial_conditions(const double r_init=R_INIT) const; // holds the FBS init conditions
 
-	void evaluate_model(std::vector<integrator::step>& results, std::string filename="");
+	void evaluate_model(integrator::Trajectory& results, std::string filename="");
     void evaluate_model();
+    /* the trajectory, events and the outer shell of the observer are taken from the workspace (trajectory slot 0, array slot 0),
+     *  which can be reused for the next star */
+    void evaluate_model(Workspace& workspace);
 
     friend std::ostream& operator<<(std::ostream&, const NSEinsteinCartanRotation&);
     static std::vector<std::string> labels();
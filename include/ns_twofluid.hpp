@@ -16,7 +16,8 @@ namespace FBS {
 // constructor: EOS (ptr), EOS2 (ptr)
 class NSTwoFluid : public NSmodel {
 protected:
-    void calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events);
+    /* The temporary arrays are taken from the workspace if given (array slots 0-3) */
+    void calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events, Workspace* workspace=nullptr);
 
 public:
 	std::shared_ptr<EquationOfState> EOS_fluid2;	// EOS of the second fluid
@@ -35,10 +36,20 @@ public:
     //vector dy_dr(const double r, const vector& vars);  // holds the system of ODEs for the Fermion Boson Star
 	/* The differential equations describing the two-fluid FBS. The quantities are nu, m1, m2, P1, P2 and y as described in PHYS. REV. D 105, 123010 (2022) */
     vector dy_dr(const double r, const vector& vars) const;
+    /* The same equations for the fixed-dimension integrator, which does not allocate memory during the integration */
+    virtual fixed_vector<6> dy_dr(const double r, const fixed_vector<6>& vars) const;
+    /* The same equations with the EoS of the types E1, E2, the calls to the EoS are not virtual if these are concrete EoS (see dispatch_eos) */
+    template <typename E1, typename E2>
+    fixed_vector<6> dy_dr(const double r, const fixed_vector<6>& vars, E1& myEOS1, E2& myEOS2) const;
+
+    /* Calls the fixed-dimension integrator for the 6 variables nu, m1, m2, P1, P2, y */
+    int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
 
     vector get_initial_conditions(const double r_init=R_INIT) const; // holds the FBS init conditions
-    void evaluate_model(std::vector<integrator::step>& results, std::string filename="");
+    void evaluate_model(integrator::Trajectory& results, std::string filename="", Workspace* workspace=nullptr);
     void evaluate_model();
+    /* the memory is taken from the workspace (trajectory slot 0, array slots 0-3), which can be reused for the next star */
+    void evaluate_model(Workspace& workspace);
 
     friend std::ostream& operator<<(std::ostream&, const NSTwoFluid&);
     static std::vector<std::string> labels();
@@ -6,6 +6,7 @@
 #include "eos.hpp"
 #include "integrator.hpp"
 #include "plotting.hpp"
+#include "workspace.hpp"
 
 namespace FBS {
 
@@ -41,13 +42,40 @@ public:
     /* The initial conditions for a, alpha, phi, Psi, and P */
     virtual vector get_initial_conditions(double r_init=R_INIT) const = 0;
 
-    /* This function calls the integrator and returns the results of the integration */
-    int integrate(std::vector<integrator::step>& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1.) const;
+    /* This function calls the integrator and returns the results of the integration
+     * The optional observer is called on every step (see integrator::Observer)
+     * Models with a fixed number of variables override this to call integrate_fixed */
+    virtual int integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts = integrator::IntegrationOptions(), double r_init=-1., double r_end=-1., integrator::Observer* observer=nullptr) const;
 
     /* For easy output the class should define an << operator */
     friend std::ostream& operator<<(std::ostream&, const NSmodel&);
     /* The labels for the different parameters that are output by the << operator */
     static std::vector<std::string> labels();
+
+protected:
+    /* The fixed-dimension dy_dr function of the model M as a callable for the integrator
+     * The call is qualified with M, so it is not virtual and the compiler can inline the equations into the steppers.
+     * This requires that M is the most derived class that overrides dy_dr, so models that override it also override integrate */
+    template <typename M, std::size_t N>
+    struct ModelRHS {
+        const M& model;
+        fixed_vector<N> operator()(const double r, const fixed_vector<N>& y, const void*) const { return model.M::dy_dr(r, y); }
+    };
+
+    /* Same as integrate, but the integrator is instantiated for the fixed_vector<N> dy_dr function of the model M,
+     * so that no memory is allocated for the intermediate steps */
+    template <typename M, std::size_t N>
+    int integrate_fixed(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector& initial_conditions, const integrator::IntegrationOptions& intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+        const ModelRHS<M, N> rhs{*static_cast<const M*>(this)};
+        return this->integrate_fixed<N>(rhs, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    }
+
+    /* Same as above, but with any callable rhs(r, y, params) for the fixed_vector<N> equations,
+     * e.g. a lambda that calls the equations of the model with the EoS of its concrete type (see dispatch_eos) */
+    template <std::size_t N, typename RHS>
+    int integrate_fixed(const RHS& rhs, integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector& initial_conditions, const integrator::IntegrationOptions& intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+        return integrator::RKF45(rhs, (r_init < 0. ? this->r_init : r_init), fixed_vector<N>(initial_conditions), (r_end < 0. ? this->r_end : r_end), (const void*) this,  result,  events, intOpts, observer);
+    }
 };
 
 /* Same as NSmodel but including previous-step functionality */
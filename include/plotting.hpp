@@ -17,9 +17,11 @@ namespace FBS{
 
 namespace plotting {
 
+void save_integration_data(const integrator::Trajectory& results, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename);
+/* for the results of the integrator with previous-step functionality */
 void save_integration_data(const std::vector<integrator::step>& results, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename);
 
-void plot_evolution(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename="", bool plot_abs=false);
+void plot_evolution(const integrator::Trajectory& results, const std::vector<integrator::Event>& events, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename="", bool plot_abs=false);
 
 
 }
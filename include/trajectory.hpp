@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>   // for std::vector
+#include <utility>  // for std::pair
+#include <stdexcept> // for std::runtime_error
+
+#include "vector.hpp"
+
+namespace FBS {
+
+namespace integrator
+{
+    /* the integrator works in steps of r and the integrated variables */
+    typedef std::pair<double, vector> step;
+
+    class Trajectory;
+
+    /* StepView
+     * a lightweight reference to one step of a Trajectory, that doesn't copy any values
+     * It is valid as long as the Trajectory isn't modified */
+    class StepView {
+    protected:
+        const Trajectory* trajectory;
+        std::size_t index;
+    public:
+        StepView(const Trajectory& trajectory, std::size_t index) : trajectory(&trajectory), index(index) {}
+
+        double r() const;
+        double operator[](unsigned int k) const;   // the k-th component of the state
+        unsigned int size() const;                  // the number of components
+        vector y() const;                           // copies the state into a vector
+    };
+
+    /* Trajectory
+     * holds the steps of an integration as a structure of arrays:
+     *  the radii and every component of the state are stored in their own contiguous column
+     * The columns grow geometrically (as std::vector does). clear() keeps the allocated memory,
+     *  so that one Trajectory can be reused for many integrations without reallocations
+     * The dimension is set by the first step that is added to an empty Trajectory
+     * Derived quantities (e.g. for the output into a file) can be appended as additional columns */
+    class Trajectory {
+    protected:
+        std::vector<double> radii;
+        std::vector<std::vector<double>> columns;
+    public:
+        Trajectory() {}
+
+        std::size_t size() const { return radii.size(); }
+        bool empty() const { return radii.empty(); }
+        unsigned int dim() const { return columns.size(); }
+        std::size_t memory() const;         // the number of bytes allocated for the columns
+
+        void clear();                       // removes all steps but keeps the memory
+        void reserve(std::size_t n);
+        void truncate(std::size_t n);       // keeps only the first n steps
+
+        template <typename State>
+        void push_back(const double r, const State& y);
+        void push_back(const step& s) { this->push_back(s.first, s.second); }
+        /* appends the steps [begin, other.size()) of another Trajectory with the same dimension */
+        void append(const Trajectory& other, std::size_t begin=0);
+        /* appends a column for a derived quantity, which needs one entry per step */
+        void add_column(std::vector<double> values);
+
+        double r(std::size_t i) const { return radii[i]; }
+        double y(std::size_t i, unsigned int k) const { return columns[k][i]; }
+        vector y(std::size_t i) const;      // copies the state of the i-th step
+
+        const std::vector<double>& r() const { return radii; }
+        const std::vector<double>& column(unsigned int k) const { return columns[k]; }
+
+        StepView operator[](std::size_t i) const { return StepView(*this, i); }
+        StepView back() const { return StepView(*this, this->size()-1); }
+        step get_step(std::size_t i) const { return std::make_pair(radii[i], this->y(i)); }
+    };
+
+    inline double StepView::r() const { return trajectory->r(index); }
+    inline double StepView::operator[](unsigned int k) const { return trajectory->y(index, k); }
+    inline unsigned int StepView::size() const { return trajectory->dim(); }
+    inline vector StepView::y() const { return trajectory->y(index); }
+
+}
+
+/* The State can be anything with size() and operator[], e.g. FBS::vector or fixed_vector<N>,
+ * so that the integrator can save its steps without converting them */
+template <typename State>
+void integrator::Trajectory::push_back(const double r, const State& y)
+{
+    if(this->empty() && columns.size() != y.size())
+        columns.resize(y.size());
+    if(columns.size() != y.size())
+        throw std::runtime_error("Trajectory: dimension mismatch");
+
+    radii.push_back(r);
+    for(unsigned int k = 0; k < columns.size(); k++)
+        columns[k].push_back(y[k]);
+}
+
+}
@@ -2,6 +2,8 @@
 
 #include <cmath>	// for mathematical functions
 #include <vector>	// for std::vector
+#include <utility>  // for std::swap
+#include <algorithm> // for std::min
 
 namespace FBS {
 // a place to aggregate helper functions which do not fit anywhere else
@@ -9,5 +11,69 @@ namespace utilities {
 
 	void fillValuesPowerLaw(const double minValue, const double maxValue, std::vector<double>& values, const int power);
 	void fillValuesLogarithmic(const double minValue, const double maxValue, std::vector<double>& values);
+
+	/* Brent's method (zeroin) for a root of f in the range [a, b] (or [b, a]), where f_a = f(a) and f_b = f(b) have different signs,
+	 *  i.e. exactly one of them is negative. It keeps a range with a sign change like the bisection, but takes secant or inverse quadratic
+	 *  interpolation steps through the last values when they shrink the range fast enough, and bisection steps otherwise.
+	 * f is evaluated once per step. Only the sign of its value decides the side, so the value may be a rough measure away from the root.
+	 * The iteration stops when the range is within rel_tol*|b|, when |f_b| <= f_tol, when the step vanishes in floating point
+	 *  or after max_steps steps. Then b is the best estimate, a is the other end of the range, and f_a, f_b are their values.
+	 * Returns the number of steps */
+	template <typename Function>
+	int brent_zeroin(Function f, double& a, double& b, double& f_a, double& f_b, const double rel_tol, const double f_tol, const int max_steps) {
+		// the notation follows Brent: b is the best estimate, c the other end of the range, a the previous b
+		double c = a, f_c = f_a;
+		double d = b - a, e = d;	// the last and second to last step
+		int steps = 0;
+		while (steps < max_steps) {
+			if ((f_b < 0.) == (f_c < 0.)) {	// b has moved to the side of c, so a becomes the other end
+				c = a; f_c = f_a;
+				d = e = b - a;
+			}
+			if (std::abs(f_c) < std::abs(f_b)) {	// b should have the smaller value
+				std::swap(b, c); std::swap(f_b, f_c);
+				a = c; f_a = f_c;
+			}
+			const double tol = rel_tol*std::abs(b), m = 0.5*(c - b);
+			if (std::abs(f_b) <= f_tol || std::abs(m) <= tol)
+				break;
+
+			bool interpolated = false;
+			if (std::abs(e) >= tol && std::abs(f_a) > std::abs(f_b)) {
+				const double s = f_b/f_a;
+				double p, q;
+				if (a == c) {	// secant
+					p = 2.*m*s;
+					q = 1. - s;
+				}
+				else {	// inverse quadratic interpolation
+					const double q_ac = f_a/f_c, r_bc = f_b/f_c;
+					p = s*(2.*m*q_ac*(q_ac - r_bc) - (b - a)*(r_bc - 1.));
+					q = (q_ac - 1.)*(r_bc - 1.)*(s - 1.);
+				}
+				if (p > 0.)
+					q = -q;
+				else
+					p = -p;
+				if (2.*p < std::min(3.*m*q - std::abs(tol*q), std::abs(e*q))) {	// the step shrinks the range fast enough
+					e = d;
+					d = p/q;
+					interpolated = true;
+				}
+			}
+			if (!interpolated)
+				d = e = m;
+
+			const double b_new = b + (std::abs(d) > tol ? d : (m > 0. ? tol : -tol));
+			if (b_new == b)	// the floating point accuracy is reached
+				break;
+			a = b; f_a = f_b;
+			b = b_new;
+			f_b = f(b);
+			steps++;
+		}
+		a = c; f_a = f_c;
+		return steps;
+	}
 }
 }
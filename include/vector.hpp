@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>    // storage of the fixed-size vector
+#include <cmath>    // for std::isnan
+#include <stdexcept> // for std::runtime_error
+
 // include the external boost/ublas library and use the n-dimensional vector class
 // see: https://www.boost.org/
 #include <boost/numeric/ublas/vector.hpp>
@@ -24,4 +28,66 @@ public:
     static bool is_nan(const vector& v);    // functions to check for NaNs
 };
 
+/* fixed_vector
+ * a vector with a compile-time dimension N that lives on the stack
+ * It is used by the integrator and the dy_dr functions of the models so that
+ *  no heap allocations are necessary during the integration
+ * Conversions from and to the dynamic FBS::vector are provided for events, results and the python bindings */
+template <std::size_t N>
+class fixed_vector : public std::array<double, N> {
+public:
+    fixed_vector() : std::array<double, N>() {} // all entries are zero
+
+    /* fills the first list.size() entries, the remaining entries of a shorter list are zero
+     *  (e.g. the state of the background, which is extended by the perturbations). A longer list is a dimension mismatch */
+    fixed_vector(std::initializer_list<double> list) : std::array<double, N>() {
+        if(list.size() > N)
+            throw std::runtime_error("fixed_vector: dimension mismatch");
+        for(unsigned i = 0; i < list.size(); ++i)
+            (*this)[i] = *(list.begin() + i);
+    }
+
+    /* copies a dynamic vector, which has to have the same dimension */
+    explicit fixed_vector(const vector& v) : std::array<double, N>() {
+        if(v.size() != N)
+            throw std::runtime_error("fixed_vector: dimension mismatch");
+        for(unsigned i = 0; i < N; ++i)
+            (*this)[i] = v[i];
+    }
+
+    vector to_vector() const {
+        vector v(N);
+        for(unsigned i = 0; i < N; ++i)
+            v[i] = (*this)[i];
+        return v;
+    }
+
+    /* gives the entries [begin, end) as a new fixed_vector */
+    template <std::size_t begin, std::size_t end>
+    fixed_vector<end-begin> sub_range() const {
+        static_assert(begin <= end && end <= N, "fixed_vector::sub_range out of range");
+        fixed_vector<end-begin> vr;
+        for(unsigned i = begin; i < end; i++)
+            vr[i-begin] = (*this)[i];
+        return vr;
+    }
+
+    static bool is_nan(const fixed_vector& v) {
+        for(unsigned i = 0; i < N; i++) {
+            if(std::isnan(v[i]))
+                return true;
+        }
+        return false;
+    }
+};
+
+/* Simple output for the fixed_vector type, in the same format as the ublas vector */
+template <std::size_t N>
+std::ostream& operator <<(std::ostream& o, const fixed_vector<N>& v) {
+    o << "[" << N << "](";
+    for(unsigned i = 0; i < N; i++)
+        o << (i > 0 ? "," : "") << v[i];
+    return o << ")";
+}
+
 }
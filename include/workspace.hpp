@@ -0,0 +1,63 @@
+#pragma once
+
+#include <iostream>
+#include <vector>   // for std::vector
+#include <memory>   // for std::unique_ptr, the slots must not move when new slots are added
+#include <mutex>    // for the registry of the thread-local workspaces
+#include <algorithm> // for std::max, std::find
+
+#include "trajectory.hpp"
+#include "integrator.hpp"
+
+namespace FBS {
+
+/* Workspace
+ * holds the memory that is needed during the evaluation of a star: the trajectories of the integration,
+ *  the events and temporary arrays, e.g. the integrands in calculate_star_parameters
+ * The memory is kept between evaluations, so once the workspace has grown to the size of the largest star,
+ *  computing further stars (e.g. in the drivers in mr_curves) doesn't allocate memory for these
+ * Trajectories and arrays are identified by small slot numbers, the functions using a workspace document their slots
+ * An unused workspace doesn't hold any memory, so it can be created as a fallback when no workspace is given
+ *
+ * A workspace must only be used by one thread at a time, thread_local_instance() gives the workspace of the calling thread
+ * The high-water marks of these thread-local workspaces are collected by total_statistics() */
+class Workspace {
+public:
+    struct Statistics {
+        std::size_t uses;           // the number of trajectories handed out
+        std::size_t max_steps;      // the largest number of steps in a trajectory
+        std::size_t max_array_size; // the largest temporary array
+        std::size_t memory;         // the bytes allocated for trajectories and arrays
+        std::size_t workspaces;     // the number of workspaces these statistics are combined from
+        Statistics() : uses(0), max_steps(0), max_array_size(0), memory(0), workspaces(0) {}
+    };
+
+    Workspace() : uses(0), max_steps(0), max_array_size(0) {}
+    virtual ~Workspace() {}
+
+    /* gives the (empty) trajectory in the slot */
+    integrator::Trajectory& trajectory(unsigned int slot=0);
+    /* gives the array in the slot with size n, the values are unspecified */
+    std::vector<double>& array(unsigned int slot, std::size_t n);
+    /* gives an empty vector for the events of an integration */
+    std::vector<integrator::Event>& events();
+
+    Statistics statistics() const;
+
+    /* The workspace of the calling thread, which lives as long as the thread */
+    static Workspace& thread_local_instance();
+    /* Combines the statistics of all thread-local workspaces, including those of finished threads
+     * The maxima are the maxima over the workspaces, the uses and the memory are summed up.
+     * Don't call this while other threads use their workspaces */
+    static Statistics total_statistics();
+
+protected:
+    std::vector<std::unique_ptr<integrator::Trajectory>> trajectories;
+    std::vector<std::unique_ptr<std::vector<double>>> arrays;
+    std::vector<integrator::Event> event_list;
+    std::size_t uses, max_steps, max_array_size;
+};
+
+std::ostream& operator <<(std::ostream& os, const Workspace::Statistics& stats);
+
+}
@@ -8,6 +8,7 @@
 #include "vector.hpp"    // include custom 5-vector class
 #include "integrator.hpp"
 #include "eos.hpp" // include eos container class
+#include "eos_registry.hpp"
 #include "nsmodel.hpp"
 #include "fbs_twofluid.hpp"
 #include "mr_curves.hpp"
@@ -32,14 +33,8 @@ void EC_star_single(double rho_0_in, double beta_in, double gamma_in, std::strin
 	double rho_0 = rho_0_in * sat_to_code; // central restmass density of the NS in units of the nucelar saturation density
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	// initialize one instance:
 	NSEinsteinCartan ECstar(myEOS, rho_0, beta, gamma);
@@ -52,7 +47,7 @@ void EC_star_single(double rho_0_in, double beta_in, double gamma_in, std::strin
 	stream >> tmp; plotname += tmp;
 
 	// evaluate the model and save the intermediate data into txt file:
-	std::vector<integrator::step> results;
+	integrator::Trajectory results;
     ECstar.evaluate_model(results, "output/" + plotname + ".txt");
 
 	// output global variables:
@@ -83,14 +78,8 @@ void EC_star_curve(unsigned Nstars_in, double rho_0_min_in, double rho_0_max_in,
 	utilities::fillValuesPowerLaw(rho_0_min, rho_0_max, rho_c_grid, 2);	// power law scaling of 2 or 3 works pretty well
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	// compute all EC neutron stars:
 	std::vector<NSEinsteinCartan> MR_curve;	// holds the stars in the MR curve
@@ -128,18 +117,12 @@ void EC_star_curve_const_mass_with_different_beta(unsigned Nstars_in, double ns_
 	utilities::fillValuesPowerLaw(beta_min, beta_max, beta_grid, 1); // linear scaling, but other scalings are possible
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	// compute all EC neutron stars:
 	std::vector<NSEinsteinCartan> MR_curve;	// holds the stars in the MR curve
-	calc_EinsteinCartan_curves_const_mass(myEOS, 1.0*sat_to_code, MR_curve, beta_grid, gamma, ns_mass, mass_quantity_label, 1);	// last argument is verbose
+	calc_EinsteinCartan_curves_const_mass(myEOS, 1.0*sat_to_code, MR_curve, beta_grid, gamma, ns_mass, mass_quantity_label, 1, true);	// verbose, continuation along the beta grid
 
 	// name of output textfile. Use stringstream for dynamic naming of output file:
 	std::stringstream stream; std::string tmp;
@@ -176,14 +159,8 @@ void EC_star_curve_rotation_rate_model_simple(unsigned Nstars_in, double rho_0_m
 	utilities::fillValuesPowerLaw(rho_0_min, rho_0_max, rho_c_grid, 2);	// power law scaling of 2 or 3 works pretty well
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	std::vector<NSEinsteinCartan> MR_curve;	// holds the stars in the MR curve
 	// compute non-rotating neutron stars without torsion:
@@ -235,14 +212,8 @@ void EC_star_curve_rotation_rate_model_e_plus_P(unsigned Nstars_in, double rho_0
 	utilities::fillValuesPowerLaw(rho_0_min, rho_0_max, rho_c_grid, 2);	// power law scaling of 2 or 3 works pretty well
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	std::vector<NSEinsteinCartanRotation> MR_curve; // holds the stars in the MR curve
 	// compute non-rotating neutron stars without torsion:
@@ -295,14 +266,8 @@ void EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(unsigned Nstars_i
 	utilities::fillValuesPowerLaw(rho_0_min, rho_0_max, rho_c_grid, 2);	// power law scaling of 2 or 3 works pretty well
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	std::vector<NSEinsteinCartanRotation> MR_curve; // holds the stars in the MR curve
 	// compute non-rotating neutron stars without torsion:
@@ -354,14 +319,8 @@ void EC_star_single_hbar(double rho_0_in, double eta_tilde_in, std::string EOS_i
 	double rho_0 = rho_0_in * sat_to_code; // central restmass density of the NS in units of the nucelar saturation density
 
 	// select correct EOS type:
-	std::string EOS_filepath = "";
-	     if(EOS_in == "EOS_DD2")    { EOS_filepath = "EOS_tables/eos_HS_DD2_with_electrons.beta";}
-	else if(EOS_in == "EOS_APR")    { EOS_filepath = "EOS_tables/eos_SRO_APR_SNA_version.beta";}
-	else if(EOS_in == "EOS_KDE0v1") { EOS_filepath = "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta";}
-	else if(EOS_in == "EOS_LNS")    { EOS_filepath = "EOS_tables/eos_SRO_LNS_SNA_version.beta";}
-	else if(EOS_in == "EOS_FSG")    { EOS_filepath = "EOS_tables/eos_HS_FSG_with_electrons.beta";}
-	else { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
-	auto myEOS = std::make_shared<EoStable>(EOS_filepath); // (load the EOS)
+	auto myEOS = EoSRegistry::instance().get(EOS_in); // (load the EOS, or share it if it was loaded before)
+	if(!myEOS) { std::cout << "Wrong EOS! Supported EOS are: 'EOS_DD2'  'EOS_APR'  'EOS_KDE0v1'  'EOS_LNS'  'EOS_FSG' !" << std::endl; return;}
 
 	// initialize one instance:
 	NSEinsteinCartanHbarSpin ECstar(myEOS, rho_0, eta_tilde);
@@ -397,46 +356,51 @@ int main() {
 	/*
 	// Plots to create data for the figures in the paper:
 	// Total run time of the code should be 15-25 min on a laptop, depending on your machine.
+	// The curves are submitted to the executor and computed at the same time, their stars are shared by all worker threads
+	Executor& executor = Executor::instance();
+	std::vector<std::future<void>> figures;
 	// Figure 1:
-	EC_star_single(4.0, 0.0, 2.0, "EOS_DD2");
-	EC_star_single(4.0, 0.0, 2.0, "EOS_APR");
+	figures.push_back(executor.submit([]() { EC_star_single(4.0, 0.0, 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_single(4.0, 0.0, 2.0, "EOS_APR"); }));
 	// Figure 2:
-	EC_star_curve(200, 0.6, 10.0, 0.0, 2.0, "EOS_DD2");
-	EC_star_curve(200, 0.6, 10.0, 10.0, 2.0, "EOS_DD2");
-	EC_star_curve(200, 0.6, 10.0, 20.0, 2.0, "EOS_DD2");
-	EC_star_curve(200, 0.6, 10.0, 100.0, 2.0, "EOS_DD2");
-	EC_star_curve(200, 0.7, 10.0, 0.0, 2.0, "EOS_APR");
-	EC_star_curve(200, 0.7, 10.0, 10.0, 2.0, "EOS_APR");
-	EC_star_curve(200, 0.7, 10.0, 20.0, 2.0, "EOS_APR");
-	EC_star_curve(200, 0.7, 10.0, 100.0, 2.0, "EOS_APR");
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.6, 10.0, 0.0, 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.6, 10.0, 10.0, 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.6, 10.0, 20.0, 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.6, 10.0, 100.0, 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.7, 10.0, 0.0, 2.0, "EOS_APR"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.7, 10.0, 10.0, 2.0, "EOS_APR"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.7, 10.0, 20.0, 2.0, "EOS_APR"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve(200, 0.7, 10.0, 100.0, 2.0, "EOS_APR"); }));
 	// Figure 3:
-	EC_star_curve_const_mass_with_different_beta(250, 0.8, "M_rest", 0.0, 101., 2.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 1.0, "M_rest", 0.0, 101., 2.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 1.4, "M_rest", 0.0, 101., 2.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 2.0, "M_rest", 0.0, 101., 2.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 0.8, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 1.0, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 1.4, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2");
-	EC_star_curve_const_mass_with_different_beta(250, 2.0, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2");
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 0.8, "M_rest", 0.0, 101., 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 1.0, "M_rest", 0.0, 101., 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 1.4, "M_rest", 0.0, 101., 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 2.0, "M_rest", 0.0, 101., 2.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 0.8, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 1.0, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 1.4, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2"); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_const_mass_with_different_beta(250, 2.0, "M_rest", 0.0, 1.0e6, 3.0, "EOS_DD2"); }));
 	// Figure 4:
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 100., "EOS_DD2", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 200., "EOS_DD2", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 300., "EOS_DD2", 0.0);
-
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.1);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.2);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.3);
-
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 100., "EOS_APR", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 200., "EOS_APR", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 300., "EOS_APR", 0.0);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 400., "EOS_APR", 0.0);
-
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.1);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.2);
-	EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.3);
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 100., "EOS_DD2", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 200., "EOS_DD2", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 300., "EOS_DD2", 0.0); }));
+
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.1); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.2); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_DD2", 0.3); }));
+
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 100., "EOS_APR", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 200., "EOS_APR", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 300., "EOS_APR", 0.0); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 400., "EOS_APR", 0.0); }));
+
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.1); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.2); }));
+	figures.push_back(executor.submit([]() { EC_star_curve_rotation_rate_model_e_plus_P_beta_iteration(200, 0.6, 10.0, 0., "EOS_APR", 0.3); }));
+
+	executor.wait_all(figures);
 	*/
     return 0;
 }
@@ -27,9 +27,21 @@ cdef extern from "eos.hpp" namespace "FBS":
     cdef cppclass CausalEoS(EquationOfState):
         CausalEoS(const double eps_f, const double P_f)
 
+    cdef cppclass PiecewisePolytropeEoS(EquationOfState):
+        PiecewisePolytropeEoS(const double log_p1, const double Gamma1, const double Gamma2, const double Gamma3) except +
 
-cdef extern from "integrator.hpp" namespace "FBS::integrator":
+
+cdef extern from "trajectory.hpp" namespace "FBS::integrator":
     ctypedef pair[double, vector] step
+
+    cdef cppclass Trajectory:
+        size_t size() const
+        unsigned int dim() const
+        const stdvector[double]& r() const
+        const stdvector[double]& column(unsigned int k) const
+
+
+cdef extern from "integrator.hpp" namespace "FBS::integrator":
     ctypedef bool (*event_condition)(const double r, const double dr, const vector& y, const vector& dy, const void*params)
 
     cdef cppclass Event:
@@ -64,9 +76,9 @@ cdef extern from "nsmodel.hpp" namespace "FBS":
 
         void get_initial_conditions()
         int bisection(double omega_0, double omega_1, int n_mode, int max_step, double delta_omega)
-        int integrate(stdvector[step]& result, stdvector[Event]& events, IntegrationOptions intOpts, double r_init, double r_end)
+        int integrate(Trajectory& result, stdvector[Event]& events, IntegrationOptions intOpts, double r_init, double r_end)
         void evaluate_model()
-        void evaluate_model(stdvector[step]& results, IntegrationOptions intOpts, string filename)
+        void evaluate_model(Trajectory& results, IntegrationOptions intOpts, string filename)
         void shooting_NbNf_ratio(double NbNf_ratio, double NbNf_accuracy, double omega_0, double omega_1, int n_mode, int max_step, double delta_omega)
 
         double M_T
@@ -77,6 +89,7 @@ cdef extern from "nsmodel.hpp" namespace "FBS":
         double R_F
         double R_F_0
         double R_G
+        int omega_integrations
 
         const Event M_converged
         const Event Psi_diverging
@@ -95,9 +108,10 @@ cdef extern from "nsmodel.hpp" namespace "FBS":
         double R_ext
 
         void get_initial_conditions(const double r_init)
-        void evaluate_model(stdvector[step]& results, string filename)
+        void evaluate_model(Trajectory& results, string filename)
         void evaluate_model()
         int bisection_phi_1(double phi_1_0, double phi_1_1, int n_mode, int max_step, double delta_phi_1)
+        int superposition_phi_1(int verbose)
 
         const Event dphi_1_diverging
         const Event phi_1_negative
@@ -110,9 +124,9 @@ cdef extern from "mr_curves.hpp" namespace "FBS":
 
     void calc_rhophi_curves(stdvector[FermionBosonStar]& MRphi_curve, int verbose);
 
-    void calc_rhophi_curves(double mu, double lam, shared_ptr[EquationOfState] EOS, const stdvector[double]& rho_c_grid, const stdvector[double]& phi_c_grid, stdvector[FermionBosonStar]& MRphi_curve, int verbose);
+    void calc_rhophi_curves(double mu, double lam, shared_ptr[EquationOfState] EOS, const stdvector[double]& rho_c_grid, const stdvector[double]& phi_c_grid, stdvector[FermionBosonStar]& MRphi_curve, int verbose, bint continuation);
 
     void calc_NbNf_curves(double mu, double lam, shared_ptr[EquationOfState] EOS, const stdvector[double]& rho_c_grid, const stdvector[double]& NbNf_grid, stdvector[FermionBosonStar]& MRphi_curve);
 
-    void calc_MRphik2_curve(const stdvector[FermionBosonStar]& MRphi_curve,  stdvector[FermionBosonStarTLN]& MRphik2_curve, int verbose);
+    void calc_MRphik2_curve(const stdvector[FermionBosonStar]& MRphi_curve,  stdvector[FermionBosonStarTLN]& MRphik2_curve, int verbose, bint superposition, bint reuse_background);
 
@@ -11,6 +11,22 @@ import numpy as np
 
 from cpyfbs cimport *
 
+
+# copies the columns of a Trajectory into an array with r in the first column and the integrated variables in the others
+cdef trajectory_to_array(const Trajectory& res):
+    cdef size_t i, n = res.size()
+    cdef unsigned int k
+    cdef const double* col
+    cdef np.ndarray[double, ndim=2] results = np.zeros([n, res.dim()+1])
+    col = res.r().data()
+    for i in range(n):
+        results[i, 0] = col[i]
+    for k in range(res.dim()):
+        col = res.column(k).data()
+        for i in range(n):
+            results[i, 1+k] = col[i]
+    return results
+
 cdef class PyEoS:
     cdef shared_ptr[EquationOfState] eos
 
@@ -47,6 +63,11 @@ cdef class PyCausalEoS(PyEoS):
     def __cinit__(self, double eps_f, double P_f=0.):
         self.eos = make_shared[CausalEoS](eps_f, P_f) # if this line fails, see https://stackoverflow.com/questions/67626270/inheritance-and-stdshared-ptr-in-cython
 
+cdef class PyPiecewisePolytropeEoS(PyEoS):
+
+    def __cinit__(self, double log_p1=34.384, double Gamma1=3.005, double Gamma2=2.988, double Gamma3=2.851):
+        self.eos = make_shared[PiecewisePolytropeEoS](log_p1, Gamma1, Gamma2, Gamma3) # if this line fails, see https://stackoverflow.com/questions/67626270/inheritance-and-stdshared-ptr-in-cython
+
 
 cdef class PyIntegrationOptions:
     cdef shared_ptr[IntegrationOptions] io
@@ -88,16 +109,11 @@ cdef class PyFermionBosonStar:
 
 
     def evaluate_model(self, PyIntegrationOptions intOpts=PyIntegrationOptions()):
-        cdef stdvector[step] res
+        cdef Trajectory res
         cdef string empty
         deref(self.fbs).evaluate_model(res, deref(intOpts.io), empty)
         self.evaluated=True
-        cdef unsigned int i,j
-        self.results = np.zeros([res.size(), res[0].second.size()+1])
-        for i in range(res.size()):
-            self.results[i, 0] = res[i].first
-            for j in range(res[i].second.size()):
-                self.results[i,1+j] = res[i].second[j]
+        self.results = trajectory_to_array(res)
         return self.results
 
     def shooting_NbNf_ratio(self, NbNf_ratio, NbNf_accuracy, omega_0, omega_1, n_mode=0, max_step=500, delta_omega=1e-15):
@@ -164,17 +180,16 @@ cdef class PyFermionBosonStarTLN(PyFermionBosonStar):
         deref(self.fbstln).bisection_phi_1(phi_1_0, phi_1_1, n_mode, max_step, delta_phi_1)
         self.evaluated=False
 
+    def superposition_phi_1(self):
+        deref(self.fbstln).superposition_phi_1(0)
+        self.evaluated=False
+
     def evaluate_model(self):
-        cdef stdvector[step] res
+        cdef Trajectory res
         cdef string empty
         deref(self.fbstln).evaluate_model(res, empty)
         self.evaluated=True
-        cdef unsigned int i,j
-        self.results = np.zeros([res.size(), res[0].second.size()+1])
-        for i in range(res.size()):
-            self.results[i, 0] = res[i].first
-            for j in range(res[i].second.size()):
-                self.results[i,1+j] = res[i].second[j]
+        self.results = trajectory_to_array(res)
         return self.results
 
     def plot(self, ax, components=[0,1,2,3,4,5,6,7,8], label=""):
@@ -217,7 +232,7 @@ cdef class PyMRcurve:
 
 
     @staticmethod
-    def from_rhophi_list(mu, lam, PyEoS eos, np.ndarray rho_c_grid, np.ndarray phi_c_grid, str filename=""):
+    def from_rhophi_list(mu, lam, PyEoS eos, np.ndarray rho_c_grid, np.ndarray phi_c_grid, str filename="", bint continuation=False):
         cdef stdvector[double] crho_c_grid
         cdef stdvector[double] cphi_c_grid
         cdef stdvector[FermionBosonStar] MRphi_curve
@@ -228,7 +243,7 @@ cdef class PyMRcurve:
         for i in range(len(phi_c_grid)):
             cphi_c_grid.push_back(phi_c_grid[i])
 
-        calc_rhophi_curves(mu, lam, eos.eos, crho_c_grid, cphi_c_grid, MRphi_curve, 2)
+        calc_rhophi_curves(mu, lam, eos.eos, crho_c_grid, cphi_c_grid, MRphi_curve, 2, continuation)
         if(not f.empty()):
             write_MRphi_curve(MRphi_curve, f)
 
@@ -255,7 +270,7 @@ cdef class PyMRcurve:
             write_MRphi_curve(MRphi_curve, f)
 
     @staticmethod
-    def calc_TLN_curve(pMRphi_curve, str filename=""):
+    def calc_TLN_curve(pMRphi_curve, str filename="", bint superposition=False, bint reuse_background=False):
         cdef stdvector[FermionBosonStar] MRphi_curve
         cdef stdvector[FermionBosonStarTLN] tln_curve
         cdef PyFermionBosonStar fbs
@@ -264,7 +279,7 @@ cdef class PyMRcurve:
         for fbs in pMRphi_curve:
             MRphi_curve.push_back(deref( fbs.fbs))
 
-        calc_MRphik2_curve(MRphi_curve, tln_curve, 2)
+        calc_MRphik2_curve(MRphi_curve, tln_curve, 2, superposition, reuse_background)
 
         if(not f.empty()):
             write_MRphi_curve(tln_curve, f)
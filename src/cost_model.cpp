@@ -0,0 +1,176 @@
+#include "cost_model.hpp"
+
+#include <unistd.h>     // for getpid, the temporary name of the history file
+
+using namespace FBS;
+
+bool CostModel::enabled = false;
+std::string CostModel::history_directory = "output/";
+unsigned int CostModel::neighbours = 4;
+unsigned int CostModel::max_count = 8;
+
+namespace {
+
+std::mutex registry_mutex;
+std::map<std::string, std::unique_ptr<CostModel>> registry;
+
+/* The features rounded to 8 significant digits, the key of their grid point.
+ * The same grid point of different runs, or read back from the history file, has the same key */
+std::vector<double> grid_key(const std::vector<double>& features) {
+    std::vector<double> key(features.size());
+    char buffer[32];
+    for(unsigned int i = 0; i < features.size(); i++) {
+        std::snprintf(buffer, sizeof(buffer), "%.8g", features[i]);
+        key[i] = std::strtod(buffer, nullptr);
+    }
+    return key;
+}
+
+}
+
+CostModel& CostModel::instance(const std::string& name, const std::vector<std::string>& feature_names) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::unique_ptr<CostModel>& model = registry[name];
+    if(!model) {
+        model.reset(new CostModel(name, feature_names));
+        model->load();
+    }
+    return *model;
+}
+
+CostModel::CostModel(const std::string& name, const std::vector<std::string>& feature_names)
+    : name(name), feature_names(feature_names), new_measurements(0) {}
+
+std::string CostModel::history_file() const {
+    return history_directory + "cost_model_" + name + ".txt";
+}
+
+/* The file has one grid point per line: the features, the number of measurements and the geometric mean of the measured times,
+ *  lines starting with # are skipped. Lines with a different number of values, e.g. from a version of the model with other features, are ignored */
+void CostModel::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ifstream infile(this->history_file());
+    std::string line;
+    while(std::getline(infile, line)) {
+        if(line.empty() || line[0] == '#')
+            continue;
+        std::istringstream stream(line);
+        std::vector<double> values;
+        double x;
+        while(stream >> x)
+            values.push_back(x);
+        if(values.size() != feature_names.size() + 2 || !(values.back() > 0.) || !(values[values.size()-2] >= 1.))
+            continue;
+        this->add(grid_key(std::vector<double>(values.begin(), values.end() - 2)), std::log(values.back()), (unsigned int)values[values.size()-2]);
+    }
+}
+
+void CostModel::add(const std::vector<double>& key, const double log_seconds, const unsigned int count) {
+    if(min_features.empty()) {
+        min_features = key;
+        max_features = key;
+    }
+    for(unsigned int i = 0; i < key.size() && i < min_features.size(); i++) {
+        min_features[i] = std::min(min_features[i], key[i]);
+        max_features[i] = std::max(max_features[i], key[i]);
+    }
+    auto inserted = points.insert(std::make_pair(key, GridPoint{log_seconds, std::min(count, max_count)}));
+    if(!inserted.second) {
+        GridPoint& point = inserted.first->second;
+        point.count = std::min(point.count + 1, max_count);
+        point.mean_log_seconds += (log_seconds - point.mean_log_seconds) / point.count;
+    }
+}
+
+/* A grid point that was seen before gives its mean directly, otherwise the k nearest grid points are kept in a short sorted list
+ *  during one pass over the grid points */
+double CostModel::predict_locked(const std::vector<double>& features) const {
+    if(points.empty())
+        return 0.;
+    const std::vector<double> key = grid_key(features);
+    auto it = points.find(key);
+    if(it != points.end())
+        return std::exp(it->second.mean_log_seconds);
+
+    const unsigned int k = std::max(neighbours, 1u);
+    std::vector<std::pair<double, double>> nearest;     // pairs of the distance and the mean ln(seconds), by increasing distance
+    nearest.reserve(k+1);
+    for(auto point = points.begin(); point != points.end(); ++point) {
+        if(point->first.size() != key.size())
+            continue;
+        double d = 0.;
+        for(unsigned int i = 0; i < key.size(); i++) {
+            const double range = max_features[i] - min_features[i];
+            const double x = range > 0. ? (key[i] - point->first[i]) / range : 0.;
+            d += x*x;
+        }
+        if(nearest.size() == k && d >= nearest.back().first)
+            continue;
+        auto position = std::upper_bound(nearest.begin(), nearest.end(), d,
+                            [](const double d, const std::pair<double, double>& p) { return d < p.first; });
+        nearest.insert(position, std::make_pair(d, point->second.mean_log_seconds));
+        if(nearest.size() > k)
+            nearest.pop_back();
+    }
+    if(nearest.empty())
+        return 0.;
+    double log_seconds = 0.;
+    for(auto p = nearest.begin(); p != nearest.end(); ++p)
+        log_seconds += p->second;
+    return std::exp(log_seconds / nearest.size());
+}
+
+double CostModel::predict(const std::vector<double>& features) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return this->predict_locked(features);
+}
+
+std::vector<std::size_t> CostModel::longest_first(const std::vector<std::vector<double>>& features, std::vector<double>& predictions) const {
+    predictions.resize(features.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(unsigned int i = 0; i < features.size(); i++)
+            predictions[i] = this->predict_locked(features[i]);
+    }
+    std::vector<std::size_t> order(features.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&predictions](const std::size_t i, const std::size_t j) { return predictions[i] > predictions[j]; });
+    return order;
+}
+
+void CostModel::record(const std::vector<double>& features, const double seconds) {
+    if(!(seconds > 0.))
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    this->add(grid_key(features), std::log(seconds), 1);
+    new_measurements++;
+}
+
+/* The file is written under a temporary name of this process and renamed, so that processes running at the same time never read
+ *  a partial history. The history is not merged with the file on disk, i.e. when several processes use the same model, the last writer wins */
+bool CostModel::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(new_measurements == 0)
+        return true;
+    const std::string filename = this->history_file(), tmpname = filename + "." + std::to_string(getpid());
+    std::ofstream outfile(tmpname);
+    if(!outfile.is_open())
+        return false;
+    outfile << "# ";
+    for(auto it = feature_names.begin(); it != feature_names.end(); ++it)
+        outfile << *it << " ";
+    outfile << "count seconds" << std::endl;
+    outfile.precision(8);
+    for(auto it = points.begin(); it != points.end(); ++it) {
+        for(auto x = it->first.begin(); x != it->first.end(); ++x)
+            outfile << *x << " ";
+        outfile << it->second.count << " " << std::exp(it->second.mean_log_seconds) << "\n";
+    }
+    outfile.close();
+    if(!outfile || std::rename(tmpname.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpname.c_str());
+        return false;
+    }
+    new_measurements = 0;
+    return true;
+}
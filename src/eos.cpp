@@ -1,7 +1,31 @@
 #include "eos.hpp"
 
+#include <charconv>  // for std::from_chars, used for reading the EOS tables
+#include <sys/stat.h>   // for fstat
+#include <sys/mman.h>   // for mmap, the EOS tables are parsed in place
+#include <fcntl.h>      // for open
+#include <unistd.h>     // for close
+
 using namespace FBS;
 
+/******************
+ * EquationOfState *
+ ******************/
+void EquationOfState::e_from_P_batch(const double* P, double* e, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        e[k] = this->get_e_from_P(P[k]);
+}
+
+void EquationOfState::rho_from_P_batch(const double* P, double* rho, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        rho[k] = this->get_rho_from_P(P[k]);
+}
+
+void EquationOfState::callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        this->callEOS(rho[k], epsilon[k], P[k]);
+}
+
 /******************
  * PolytropicEoS *
  ******************/
@@ -9,17 +33,45 @@ double PolytropicEoS::get_P_from_rho(const double rho, const double epsilon) {
 	return this->kappa*std::pow(rho, this->Gamma);
 }
 
+namespace {
+
+const double MeV_fm3_to_codeunits =	2.886376934e-6; // unit conversion from Mev/fm^3 to code units M_s*c^2/ (G*M_s/c^2)^3
+const double neutron_mass = 939.565379;	 // nuclear density in MeV
+
+/* Solves (1 + a) rho + K/(Gamma - 1) rho^Gamma = e for rho with Newton's method
+ * The left side is increasing and convex in rho, so the iteration decreases monotonically to the solution
+ *  when it starts at rho_start above it */
+double polytrope_rho_from_e(const double e, const double K, const double Gamma, const double a, double rho_start) {
+    double rho = rho_start;
+    for(int i = 0; i < 100; i++) {
+        const double P = K*std::pow(rho, Gamma);
+        const double f = (1. + a)*rho + P/(Gamma - 1.) - e;
+        const double df = (1. + a) + Gamma*P/((Gamma - 1.)*rho);   // = (e+P)/rho
+        const double step = f/df;
+        rho -= step;
+        if(!(std::abs(step) > 1e-15*rho) || rho <= 0.)
+            break;
+    }
+    return std::max(rho, 0.);
+}
+
+/* A starting point above the solution: both terms on the left side are positive for Gamma > 1 and a > -1,
+ *  so rho is below the value at which either of them alone equals e */
+inline double polytrope_rho_bound(const double e, const double K, const double Gamma, const double a) {
+    return std::min(e/(1. + a), std::pow(e*(Gamma - 1.)/K, 1./Gamma));
+}
+
+}
+
 double PolytropicEoS::get_P_from_e(const double etot_in) {
-	// todo, maybe have to do root finding?
-	throw std::runtime_error("not implemented");
-	return 0.0;
+    if(etot_in <= 0.)
+        return 0.;
+    const double rho = polytrope_rho_from_e(etot_in, this->kappa, this->Gamma, 0., polytrope_rho_bound(etot_in, this->kappa, this->Gamma, 0.));
+	return this->kappa*std::pow(rho, this->Gamma);
 }
 
-double PolytropicEoS::get_e_from_P(const double P_in) {
-	// etot = rho*(1+epsilon)
-	double myrho = std::pow(P_in / this->kappa, 1./this->Gamma);
-    double epsilon = this->kappa*std::pow(myrho, this->Gamma - 1.) / (this->Gamma - 1.);
-	return ( myrho*(1. + epsilon) );
+double PolytropicEoS::get_rho_from_P(const double P_in) {
+	return std::pow(P_in / this->kappa, 1./this->Gamma);
 }
 
 double PolytropicEoS::dP_drho(const double rho_in, const double epsilon) {
@@ -28,8 +80,10 @@ double PolytropicEoS::dP_drho(const double rho_in, const double epsilon) {
 }
 
 double PolytropicEoS::dP_de(const double e) {
-	throw std::runtime_error("not implemented");
-	return 0.0;	// TBD
+    if(e <= 0.)
+        return 0.;
+    const double P = this->get_P_from_e(e);
+	return this->Gamma*P / (e + P);
 }
 
 
@@ -42,16 +96,142 @@ void PolytropicEoS::callEOS(double& rho, double& epsilon, const double P) {
     return;
 }
 
-double PolytropicEoS::min_P() {
-    return 0.;
+/*************************
+ * PiecewisePolytropeEoS *
+ *************************/
+
+/* The pieces are built from the bottom of the crust. The constants of the SLy crust are those of Table II of Read et al.,
+ *  in cgs units with P/c^2 in g/cm^3 */
+PiecewisePolytropeEoS::PiecewisePolytropeEoS(const double log_p1, const double Gamma1, const double Gamma2, const double Gamma3)
+    : log_p1(log_p1), Gamma1(Gamma1), Gamma2(Gamma2), Gamma3(Gamma3) {
+
+    const double gcm3_to_codeunits = MeV_fm3_to_codeunits / 1.782661921e12;  // 1 MeV/c^2/fm^3 = 1.782661921e12 g/cm^3
+    const double c2 = 8.98755178737e20;   // c^2 in cm^2/s^2, to convert dyn/cm^2 to g/cm^3
+    const double crust_K[4] = {6.80110e-9, 1.06186e-6, 5.32697e1, 3.99874e-8};
+    const double crust_Gamma[4] = {1.58425, 1.28733, 0.62223, 1.35692};
+    const double crust_rho[4] = {0., 2.44034e7, 3.78358e11, 2.62780e12};   // the lower boundaries
+    const double rho_1 = std::pow(10., 14.7), rho_2 = 1e15;
+
+    // the core in cgs, joined to the crust at rho_0
+    const double K1 = std::pow(10., log_p1) / c2 / std::pow(rho_1, Gamma1);
+    const double K2 = K1 * std::pow(rho_1, Gamma1 - Gamma2);
+    const double K3 = K2 * std::pow(rho_2, Gamma2 - Gamma3);
+    const double rho_0 = std::pow(crust_K[3] / K1, 1./(Gamma1 - crust_Gamma[3]));
+    if(!(rho_0 > crust_rho[3] && rho_0 < rho_1))
+        throw std::runtime_error("PiecewisePolytropeEoS: the core doesn't meet the crust between "
+                                    + std::to_string(crust_rho[3]) + " and " + std::to_string(rho_1) + " g/cm^3");
+
+    const double K[7] = {crust_K[0], crust_K[1], crust_K[2], crust_K[3], K1, K2, K3};
+    const double G[7] = {crust_Gamma[0], crust_Gamma[1], crust_Gamma[2], crust_Gamma[3], Gamma1, Gamma2, Gamma3};
+    const double rho[7] = {crust_rho[0], crust_rho[1], crust_rho[2], crust_rho[3], rho_0, rho_1, rho_2};
+
+    // in code units, K rho^Gamma scales like rho, so K scales with the density unit to the power 1 - Gamma
+    pieces.resize(7);
+    for(unsigned int i = 0; i < 7; i++) {
+        Piece& piece = pieces[i];
+        piece.Gamma = G[i];
+        piece.K = K[i] * std::pow(gcm3_to_codeunits, 1. - G[i]);
+        piece.rho = rho[i] * gcm3_to_codeunits;
+        piece.P = piece.K * std::pow(piece.rho, piece.Gamma);
+        // e is continuous at the boundary, a = 0 in the lowest piece so that e -> rho for rho -> 0
+        if(i == 0)
+            piece.a = 0.;
+        else
+            piece.a = pieces[i-1].a + pieces[i-1].K/(pieces[i-1].Gamma - 1.) * std::pow(piece.rho, pieces[i-1].Gamma - 1.)
+                                    - piece.K/(piece.Gamma - 1.) * std::pow(piece.rho, piece.Gamma - 1.);
+        piece.e = (1. + piece.a) * piece.rho + piece.P / (piece.Gamma - 1.);
+    }
 }
-double PolytropicEoS::min_rho() {
-    return 0.;
+
+const PiecewisePolytropeEoS::Piece& PiecewisePolytropeEoS::piece_from_e(const double e) const {
+    std::size_t i = pieces.size() - 1;
+    while(i > 0 && e < pieces[i].e)
+        i--;
+    return pieces[i];
+}
+
+/* Newton's method starts at the upper boundary of the piece, or for the last piece at the bound of polytrope_rho_bound.
+ * In the crust piece with Gamma < 1 the second term is negative and small, so there e is nearly linear in rho */
+double PiecewisePolytropeEoS::rho_from_e(const Piece& piece, const double e) const {
+    const std::size_t i = &piece - pieces.data();
+    double rho_start = (i+1 < pieces.size() ? pieces[i+1].rho : e/(1. + piece.a));
+    if(piece.Gamma > 1.)
+        rho_start = std::min(rho_start, polytrope_rho_bound(e, piece.K, piece.Gamma, piece.a));
+    return polytrope_rho_from_e(e, piece.K, piece.Gamma, piece.a, rho_start);
 }
-double PolytropicEoS::min_e() {
-    return 0.;
+
+double PiecewisePolytropeEoS::get_P_from_rho(const double rho_in, const double epsilon) {
+    std::size_t i = pieces.size() - 1;
+    while(i > 0 && rho_in < pieces[i].rho)
+        i--;
+    return pieces[i].K * std::pow(rho_in, pieces[i].Gamma);
 }
 
+double PiecewisePolytropeEoS::get_P_from_e(const double etot_in) {
+    if(etot_in <= 0.)
+        return 0.;
+    const Piece& piece = this->piece_from_e(etot_in);
+    return piece.K * std::pow(this->rho_from_e(piece, etot_in), piece.Gamma);
+}
+
+double PiecewisePolytropeEoS::dP_drho(const double rho_in, const double epsilon) {
+    std::size_t i = pieces.size() - 1;
+    while(i > 0 && rho_in < pieces[i].rho)
+        i--;
+    return pieces[i].Gamma * pieces[i].K * std::pow(rho_in, pieces[i].Gamma - 1.);
+}
+
+double PiecewisePolytropeEoS::dP_de(const double e) {
+    if(e <= 0.)
+        return 0.;
+    const Piece& piece = this->piece_from_e(e);
+    const double P = piece.K * std::pow(this->rho_from_e(piece, e), piece.Gamma);
+    return piece.Gamma * P / (e + P);
+}
+
+/* The same in closed form, as rho is known */
+double PiecewisePolytropeEoS::dP_de(const double rho, double epsilon) {
+    const double P = this->get_P_from_rho(rho, epsilon);
+    const double e = rho * (1. + epsilon);
+    return e + P > 0. ? this->dP_drho(rho, epsilon) * rho / (e + P) : 0.;
+}
+
+void PiecewisePolytropeEoS::callEOS(double& rho, double& epsilon, const double P) {
+    const Piece& piece = this->piece_from_P(P);
+    rho = std::pow(P / piece.K, 1./piece.Gamma);
+    epsilon = piece.a + piece.K/(piece.Gamma - 1.) * std::pow(rho, piece.Gamma - 1.);
+}
+
+/* The classes are final, so the calls in the loops are not virtual */
+void PolytropicEoS::e_from_P_batch(const double* P, double* e, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        e[k] = this->get_e_from_P(P[k]);
+}
+
+void PolytropicEoS::rho_from_P_batch(const double* P, double* rho, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        rho[k] = std::pow(P[k] / this->kappa, 1./this->Gamma);
+}
+
+void PolytropicEoS::callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        this->callEOS(rho[k], epsilon[k], P[k]);
+}
+
+void PiecewisePolytropeEoS::e_from_P_batch(const double* P, double* e, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        e[k] = this->get_e_from_P(P[k]);
+}
+
+void PiecewisePolytropeEoS::rho_from_P_batch(const double* P, double* rho, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        rho[k] = this->get_rho_from_P(P[k]);
+}
+
+void PiecewisePolytropeEoS::callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n) {
+    for (std::size_t k = 0; k < n; k++)
+        this->callEOS(rho[k], epsilon[k], P[k]);
+}
 
 /******************
  *  CausalEoS *
@@ -67,14 +247,9 @@ double CausalEoS::get_P_from_e(const double etot) {
     return this->P_f + etot - this->eps_f;   // p = P_f + eps - eps_f
 }
 
-double CausalEoS::get_e_from_P(const double P) {
-
-    return P - this->P_f + this->eps_f;   // p = P_f + eps - eps_f
-}
-
-double CausalEoS::dP_de(const double e) {
+double CausalEoS::get_rho_from_P(const double P) {
 
-	return 1.;   // p = P_f + eps - eps_f
+    return P - this->P_f + this->eps_f;   // the same as in callEOS, epsilon = 0
 }
 
 double CausalEoS::dP_drho(const double rho_in, const double epsilon) {
@@ -90,17 +265,6 @@ void CausalEoS::callEOS(double& rho, double& epsilon, const double P) {
         epsilon = 0.;
 }
 
-double CausalEoS::min_P() {
-    return 0.;
-}
-double CausalEoS::min_rho() {
-    return 0.;
-}
-double CausalEoS::min_e() {
-    return 0.;
-}
-
-
 /* EffectiveBosonicEoS */
 double EffectiveBosonicEoS::get_P_from_rho(const double rho_in, const double epsilon) {
 	// (note: if for some reason, this function causes problems, then it is likely better to implement a root-finding algorithm to find Phi_eff))
@@ -129,14 +293,10 @@ double EffectiveBosonicEoS::get_P_from_e(const double etot_in) {
 	return ( (4./9.)*this->rho0*std::pow( std::sqrt(1.+ (3./4.)*(etot_in/this->rho0) )-1.0, 2) );	// p = 4/9 * rho0 * ( sqrt(1 + 3/4 * rho/rho0) -1 )^2
 }
 
-double EffectiveBosonicEoS::get_e_from_P(const double P_in) {
-	// etot is the total energy density of the fluid
-	return ( 3.*P_in + 4.* std::sqrt( P_in * this->rho0) );	// positive root taken fron rho= 3*P +/- 4* sqrt(P*rho0) );	// p = 4/9 * rho0 * ( sqrt(1 + 3/4 * rho/rho0) -1 )^2
-}
-
-double EffectiveBosonicEoS::dP_de(const double etot_in) {
-	// etot is actually the total energy density of the fluid
-	return ( 1./3. - std::pow(1.+ (3./4.)*(etot_in/this->rho0) , -0.5) / 3.0 );
+double EffectiveBosonicEoS::get_rho_from_P(const double P_in) {
+	double myrho, epsilon;
+	this->callEOS(myrho, epsilon, P_in);
+	return myrho;
 }
 
 double EffectiveBosonicEoS::dP_drho(const double rho_in, const double epsilon) {
@@ -165,16 +325,6 @@ void EffectiveBosonicEoS::callEOS(double& myrho, double& epsilon, const double P
 	return;
 }
 
-double EffectiveBosonicEoS::min_P() {
-    return 0.;
-}
-double EffectiveBosonicEoS::min_rho() {
-    return 0.;
-}
-double EffectiveBosonicEoS::min_e() {
-    return 0.;
-}
-
 double EffectiveBosonicEoS::get_mu() {
 	return this->mu;
 }
@@ -187,6 +337,98 @@ double EffectiveBosonicEoS::get_lambda() {
  ******************/
 
 
+namespace {
+
+inline double to_code_units(const double value, const EoSTableFormat::Unit unit) {
+    switch(unit) {
+        case EoSTableFormat::MeV_fm3:   return value * MeV_fm3_to_codeunits;
+        case EoSTableFormat::per_fm3:   return value * MeV_fm3_to_codeunits * neutron_mass;
+        default:                        return value;
+    }
+}
+
+inline bool is_separator(const char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',';
+}
+
+/* MappedFile
+ * the content of a file mapped read-only into memory, empty if the file can't be opened */
+class MappedFile {
+public:
+    MappedFile(const std::string& filename) : data(nullptr), length(0), opened(false) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if(fd < 0)
+            return;
+        struct stat st;
+        if(fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p != MAP_FAILED) {
+                data = (const char*)p;
+                length = st.st_size;
+            }
+        }
+        opened = true;
+        close(fd);
+    }
+    ~MappedFile() { if(data) munmap((void*)data, length); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data;
+    std::size_t length;
+    bool opened;
+};
+
+}
+
+EoSTableFormat EoSTableFormat::compose() {
+    EoSTableFormat format;
+    format.name = "compose";
+    format.columns = { {"n_b", "rho", per_fm3}, {"Y_e", "", code_units}, {"e", "e", MeV_fm3}, {"P", "P", MeV_fm3} };
+    format.comment_markers = "#";
+    format.monotonicity = keep;
+    return format;
+}
+
+EoSTableFormat EoSTableFormat::jan_erik() {
+    EoSTableFormat format;
+    format.name = "jan_erik";
+    format.columns = { {"n_b", "rho", per_fm3}, {"row", "", code_units}, {"P", "P", MeV_fm3}, {"e", "e", MeV_fm3} };
+    format.comment_markers = "#";
+    format.monotonicity = drop;
+    return format;
+}
+
+EoSTableFormat EoSTableFormat::from_indices(const std::map<std::string, int>& indices) {
+    EoSTableFormat format;
+    format.name = "indices";
+    const int max_index = std::max( std::max(indices.at("rho"), indices.at("P")), indices.at("e"));
+    format.columns.resize(max_index+1, Column{"", "", code_units});
+    format.columns[indices.at("rho")] = Column{"rho", "rho", per_fm3};
+    format.columns[indices.at("e")] = Column{"e", "e", MeV_fm3};
+    format.columns[indices.at("P")] = Column{"P", "P", MeV_fm3};
+    format.comment_markers = "#";
+    format.monotonicity = keep;
+    return format;
+}
+
+/* FNV-1a over the quantities and units of the columns and the options */
+std::uint64_t EoSTableFormat::fingerprint() const {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const std::string& s) {
+        for(unsigned char c : s)
+            hash = (hash ^ c) * 1099511628211ull;
+        hash = (hash ^ 0xff) * 1099511628211ull;    // terminates the string
+    };
+    for(auto it = columns.begin(); it != columns.end(); ++it) {
+        add(it->quantity);
+        add(std::to_string((int)it->unit));
+    }
+    add(comment_markers);
+    add(std::to_string((int)monotonicity));
+    return hash;
+}
+
 /* This function expects a filename to a table.
  * The table has to contain the rest mass density rho, P_tablesure P, energy density e
  * The indices of these values is given by the std::map such that
@@ -195,58 +437,406 @@ double EffectiveBosonicEoS::get_lambda() {
  *       indices["P"] corresponds to the column of P_tablesure [MeV/fm^3]
  *
  * Columns are counted starting from 0
- * Lines containing # are ignored
+ * Text after # is ignored
  */
 bool EoStable::load_from_file(const std::string filename, std::map<std::string, int> indices) {
+    return load_from_file(filename, EoSTableFormat::from_indices(indices));
+}
 
-    const double MeV_fm3_to_codeunits =	2.886376934e-6; // unit conversion from Mev/fm^3 to code units M_s*c^2/ (G*M_s/c^2)^3
-    const double neutron_mass = 939.565379;	 // nuclear density in MeV
+/* This function expects a filename to a table with the following structure
+ *
+ * | restmass density rho [1/fm^3] |  (skipped)  | energy density[MeV/fm^3]  |  P_tablesure[MeV/fm^3] |
+ *
+ * and calls load_from_file with this format
+ */
+bool EoStable::load_from_file(const std::string filename) {
+    return load_from_file(filename, EoSTableFormat::compose());
+}
 
-    std::ifstream infile;
-    infile.open(filename);
-    if(!infile.is_open())
+/* The file is mapped into memory and the values are read in place with std::from_chars
+ * Every row has to have values for all columns up to the last one that is used, the columns after it are ignored */
+bool EoStable::load_from_file(const std::string filename, const EoSTableFormat& format) {
+    this->check_not_frozen("loaded again");
+    MappedFile file(filename);
+    if(!file.opened)
         return false;
 
-    rho_table.clear(); P_table.clear(); e_table.clear();
-    int max_index = 0.;
-    max_index = std::max( std::max(indices.at("rho"), indices.at("P")), indices.at("e"));
+    // the quantity of every column: 0 = rho, 1 = e, 2 = P, -1 = skipped
+    std::vector<int> quantity(format.columns.size(), -1);
+    std::size_t n_columns = 0;
+    for(std::size_t k = 0; k < format.columns.size(); k++) {
+        const std::string& q = format.columns[k].quantity;
+        quantity[k] = (q == "rho" ? 0 : (q == "e" ? 1 : (q == "P" ? 2 : -1)));
+        if(quantity[k] >= 0)
+            n_columns = k+1;
+        else if(!q.empty())
+            throw std::runtime_error("EoSTableFormat '" + format.name + "': unknown quantity '" + q + "'");
+    }
+    for(int i = 0; i < 3; i++) {
+        if(std::find(quantity.begin(), quantity.end(), i) == quantity.end())
+            throw std::runtime_error("EoSTableFormat '" + format.name + "': rho, e and P need a column each");
+    }
 
     std::cout << "loading EoS table " << filename << std::endl; // TODO: Check error that arises when this is commented out xD
-    std::string line;
-    while (std::getline(infile, line)) {
-        double temp;
-        std::stringstream ss(line);
-
-		// ignore lines with '#' in it (to make comment in the table)
-		if (line.find('#') != std::string::npos)
-    		continue;
-
-        for(int i = 0; i < max_index+1; i++) {
-            ss >> temp;
-            if( i == indices.at("rho"))
-                rho_table.push_back(temp * MeV_fm3_to_codeunits * neutron_mass);
-            if( i ==  indices.at("P"))
-                P_table.push_back(temp * MeV_fm3_to_codeunits);
-            if( i == indices.at("e"))
-                e_table.push_back(temp * MeV_fm3_to_codeunits);
+    std::vector<double> rho_table, P_table, e_table;
+    std::size_t n_reported = 0, first_reported = 0;
+    double values[3];
+    const char* p = file.data;
+    const char* const end = file.data + file.length;
+    for(std::size_t line = 1; p < end; line++) {
+        const char* line_end = (const char*)std::memchr(p, '\n', end - p);
+        if(!line_end)
+            line_end = end;
+        const char* content_end = line_end;
+        for(const char* c = p; c < line_end; c++) {
+            if(format.comment_markers.find(*c) != std::string::npos) {
+                content_end = c;
+                break;
+            }
+        }
+
+        std::size_t k = 0;
+        while(true) {
+            while(p < content_end && is_separator(*p))
+                p++;
+            if(p == content_end || k == n_columns)
+                break;
+            const char* value_end = p;
+            while(value_end < content_end && !is_separator(*value_end))
+                value_end++;
+            if(quantity[k] >= 0) {
+                double value;
+                const char* begin = (*p == '+' ? p+1 : p);  // from_chars doesn't accept a leading +
+                std::from_chars_result res = std::from_chars(begin, value_end, value);
+                if(res.ec != std::errc() || res.ptr != value_end)
+                    throw std::runtime_error(filename + ":" + std::to_string(line) + ": can't read the value of column '"
+                                                + format.columns[k].name + "': '" + std::string(p, value_end) + "'");
+                values[quantity[k]] = to_code_units(value, format.columns[k].unit);
+            }
+            p = value_end;
+            k++;
         }
+        p = line_end + 1;
+        if(k == 0)
+            continue;   // empty line or comment
+        if(k < n_columns)
+            throw std::runtime_error(filename + ":" + std::to_string(line) + ": expected " + std::to_string(n_columns)
+                                        + " columns, found " + std::to_string(k));
+
+        // check that P is monotone
+        if(!P_table.empty() && format.monotonicity == EoSTableFormat::drop) {
+            if(values[0] <= rho_table.back() || values[1] <= e_table.back() || values[2] <= P_table.back()) {
+                if(n_reported++ == 0)
+                    first_reported = line;
+                continue;
+            }
+        }
+        else if(!P_table.empty() && values[2] < P_table.back()) {
+            if(format.monotonicity == EoSTableFormat::error)
+                throw std::runtime_error(filename + ":" + std::to_string(line) + ": P decreases");
+            if(n_reported++ == 0)
+                first_reported = line;
+        }
+        rho_table.push_back(values[0]);
+        e_table.push_back(values[1]);
+        P_table.push_back(values[2]);
     }
-    infile.close();
+
+    if(n_reported > 0) {
+        std::ostringstream message;
+        message << "EoS table " << filename << ": "
+                << (format.monotonicity == EoSTableFormat::drop ? "dropped " : "P decreases in ") << n_reported
+                << (format.monotonicity == EoSTableFormat::drop ? " rows where rho, e or P don't increase" : " rows")
+                << " (first in line " << first_reported << ")" << std::endl;
+        std::cout << message.str();
+    }
+    this->set_table(rho_table, P_table, e_table);
     return true;
 }
 
-/* This function expects a filename to a table with the following structure
- *
- * | restmass density rho [1/fm^3] |  (skipped)  | energy density[MeV/fm^3]  |  P_tablesure[MeV/fm^3] |
- *
- * and calls load_from_file with these indices
- */
-bool EoStable::load_from_file(const std::string filename) {
-    std::map<std::string, int> indices;
-    indices["rho"] = 0;
-    indices["e"] = 2;
-    indices["P"] = 3;
-    return load_from_file(filename, indices);
+namespace {
+
+/* The slope of Fritsch and Butland at a point between the intervals of the widths h0, h1 and the slopes d0, d1
+ *  a weighted harmonic mean, which keeps a monotone interpolant monotone */
+inline double monotone_slope(const double h0, const double h1, const double d0, const double d1) {
+    if (d0*d1 <= 0.)
+        return 0.;  // a local extremum, the slope has to vanish for monotonicity
+    return 3.*(h0 + h1) / ((2.*h1 + h0)/d0 + (h1 + 2.*h0)/d1);
+}
+
+/* MonotoneCubic
+ * a monotone cubic Hermite interpolant of the points (x, y), with the slopes of Fritsch and Butland
+ * x has to be strictly increasing. Outside of the points the first or last cubic is extrapolated */
+class MonotoneCubic {
+public:
+    MonotoneCubic(const std::vector<double>& x, const std::vector<double>& y) : x(x), y(y), m(x.size(), 0.) {
+        const std::size_t n = x.size();
+        if (n < 2)
+            return;
+        std::vector<double> d(n-1);
+        for (std::size_t k = 0; k < n-1; k++)
+            d[k] = (y[k+1] - y[k]) / (x[k+1] - x[k]);
+        m[0] = d[0];
+        m[n-1] = d[n-2];
+        for (std::size_t k = 1; k < n-1; k++)
+            m[k] = monotone_slope(x[k] - x[k-1], x[k+1] - x[k], d[k-1], d[k]);
+    }
+
+    /* gives the value y and the derivative dy/dx at x */
+    void evaluate(const double x_in, double& y_out, double& dy_dx) const {
+        std::size_t k = std::upper_bound(x.begin(), x.end(), x_in) - x.begin();
+        k = std::min(std::max(k, (std::size_t)1), x.size()-1) - 1;
+        const double h = x[k+1] - x[k], t = (x_in - x[k]) / h;
+        const double t2 = t*t, t3 = t2*t;
+        y_out = (2.*t3 - 3.*t2 + 1.)*y[k] + (t3 - 2.*t2 + t)*h*m[k] + (-2.*t3 + 3.*t2)*y[k+1] + (t3 - t2)*h*m[k+1];
+        dy_dx = ((6.*t2 - 6.*t)*y[k] + (3.*t2 - 4.*t + 1.)*h*m[k] + (-6.*t2 + 6.*t)*y[k+1] + (3.*t2 - 2.*t)*h*m[k+1]) / h;
+    }
+
+private:
+    std::vector<double> x, y, m;
+};
+
+}
+
+void EoStable::check_not_frozen(const std::string& change) const {
+    if (frozen)
+        throw std::runtime_error("EoStable: the table is frozen, it can't be " + change);
+}
+
+void EoStable::set_use_hint(const bool hint) {
+    this->check_not_frozen("changed");
+    this->use_hint = hint;
+}
+
+/* This builds the nodes from the columns of the table
+ * The columns are expected to be monotone */
+void EoStable::set_table(const std::vector<double>& rho_table, const std::vector<double>& P_table, const std::vector<double>& e_table) {
+    if(rho_table.size() != P_table.size() || e_table.size() != P_table.size())
+        throw std::runtime_error("EoStable: the columns of the table have different lengths");
+
+    unsigned int table_len = P_table.size();
+    resampled = false;
+    P_index.cells.clear();
+    rho_index.cells.clear();
+    nodes.resize(table_len);
+    for (unsigned int i = 0; i < table_len; i++) {
+        nodes[i].P = P_table[i];
+        nodes[i].e = e_table[i];
+        nodes[i].rho = rho_table[i];
+    }
+    this->compute_derivatives();
+}
+
+/* The derivatives at the nodes are the averages of the slopes of the neighbouring intervals, one-sided at the ends of the table.
+ *  Between the nodes they are interpolated linearly, so they are continuous.
+ * Over an interval their mean stays close to the slope of the interval, i.e. to the derivative of the linear interpolation of e(P) and rho(P).
+ *  The slopes of monotone cubic interpolants (Fritsch and Butland) do not, k2 of a tabulated polytrope is then further off from the analytic one */
+void EoStable::compute_derivatives() {
+    const std::size_t table_len = nodes.size();
+    node_dP_drho.resize(table_len);
+    // the slope of the interval [i-1, i], 0. if the interval is empty
+    auto slope = [this](const std::size_t i, double Node::* x) {
+        const double dx = nodes[i].*x - nodes[i-1].*x;
+        return dx > 0. ? (nodes[i].P - nodes[i-1].P) / dx : 0.;
+    };
+    for (std::size_t i = 0; i < table_len; i++) {
+        Node& node = nodes[i];
+        if (table_len < 2) {
+            node.dP_de = node_dP_drho[i] = 0.;
+        }
+        else if (i == 0) {
+            node.dP_de = slope(1, &Node::e);
+            node_dP_drho[i] = slope(1, &Node::rho);
+        }
+        else if (i == table_len-1) {
+            node.dP_de = slope(i, &Node::e);
+            node_dP_drho[i] = slope(i, &Node::rho);
+        }
+        else {
+            node.dP_de = slope(i+1, &Node::e)/2. + slope(i, &Node::e)/2.;
+            node_dP_drho[i] = slope(i+1, &Node::rho)/2. + slope(i, &Node::rho)/2.;
+        }
+    }
+}
+
+namespace {
+
+/* The index of the last lookup of the calling thread for every key, see EoStable::upper_index
+ *  These are shared between all tables, the index is checked before it is used */
+struct LastIndex {
+    std::size_t P, e, rho;
+};
+thread_local LastIndex last_index = {1, 1, 1};
+
+}
+
+std::size_t EoStable::upper_index(double Node::* key, const double x) const {
+    std::size_t& hint = (key == &Node::P ? last_index.P : (key == &Node::e ? last_index.e : last_index.rho));
+    return this->upper_index(key, x, hint);
+}
+
+std::size_t EoStable::upper_index(double Node::* key, const double x, std::size_t& hint) const {
+    const std::size_t table_len = nodes.size();
+    if (table_len < 2)
+        return table_len;
+    if (resampled && key == &Node::P)
+        return this->upper_index(P_index, key, x);
+    if (resampled && key == &Node::rho)
+        return this->upper_index(rho_index, key, x);
+
+    if (use_hint) {
+        // try the last interval and its neighbours, as x mostly changes by a small amount between two calls
+        for (std::size_t i = (hint > 1 ? hint-1 : 1); i <= hint+1 && i < table_len; i++) {
+            if (nodes[i].*key > x && (i == 1 || nodes[i-1].*key <= x)) {
+                hint = i;
+                return i;
+            }
+        }
+    }
+
+    auto it = std::upper_bound(nodes.begin() + 1, nodes.end(), x, [key](const double x, const Node& node) { return x < node.*key; });
+    hint = it - nodes.begin();
+    return hint;
+}
+
+namespace {
+
+/* A monotone, piecewise linear approximation of log2(x) for positive, normal x: the exponent plus the fraction of the mantissa.
+ * It only needs the bits of x, so it is much cheaper than std::log and suffices to select the cell of an index */
+inline double fast_log2(const double x) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const double exponent = static_cast<double>(static_cast<int>(bits >> 52) - 1023);
+    return exponent + static_cast<double>(bits & ((std::uint64_t(1) << 52) - 1)) / static_cast<double>(std::uint64_t(1) << 52);
+}
+
+/* the inverse of fast_log2 */
+inline double fast_exp2(const double y) {
+    const double exponent = std::floor(y);
+    return std::ldexp(1. + (y - exponent), static_cast<int>(exponent));
+}
+
+}
+
+std::size_t EoStable::upper_index(const LogIndex& index, double Node::* key, const double x) const {
+    const std::size_t table_len = nodes.size();
+    if (!(x >= nodes[1].*key))
+        return 1;
+    if (x >= nodes[table_len-1].*key)
+        return table_len;
+
+    const double cell = (fast_log2(x) - index.log_x0) * index.inv_dlog_x;
+    std::size_t i = index.cells[std::min(static_cast<std::size_t>(std::max(cell, 0.)), index.cells.size()-1)];
+    // the rounding of the logarithm can give the neighbouring cell, then one of these corrects it
+    while (i > 1 && nodes[i-1].*key > x)
+        i--;
+    while (nodes[i].*key <= x)
+        i++;
+    return i;
+}
+
+void EoStable::build_index(LogIndex& index, double Node::* key, const std::size_t n_cells) {
+    const double log_x0 = fast_log2(nodes.front().*key), log_x1 = fast_log2(nodes.back().*key);
+    index.log_x0 = log_x0;
+    index.inv_dlog_x = n_cells / (log_x1 - log_x0);
+    index.cells.resize(n_cells);
+    std::size_t i = 1;
+    for (std::size_t k = 0; k < n_cells; k++) {
+        const double lower = fast_exp2(log_x0 + k / index.inv_dlog_x);
+        while (i < nodes.size()-1 && nodes[i].*key <= lower)
+            i++;
+        index.cells[k] = i;
+    }
+}
+
+void EoStable::resample_log_uniform(const unsigned int points) {
+    this->check_not_frozen("resampled");
+    if (resampled)
+        throw std::runtime_error("EoStable: the table is already resampled");
+    if (points < 2)
+        throw std::runtime_error("EoStable: at least 2 points are needed for the resampling");
+
+    // the rows of the table that can be used in log P, i.e. positive values and strictly increasing P and rho
+    std::vector<Node> table;
+    std::vector<double> log_P, log_e;
+    for (auto it = nodes.begin(); it != nodes.end(); ++it) {
+        if (it->P <= 0. || it->e <= 0. || it->rho <= 0. || (!table.empty() && (it->P <= table.back().P || it->rho <= table.back().rho)))
+            continue;
+        table.push_back(*it);
+        log_P.push_back(std::log(it->P));
+        log_e.push_back(std::log(it->e));
+    }
+    if (table.size() < 2)
+        throw std::runtime_error("EoStable: the table has too few rows with positive values for the resampling");
+    const MonotoneCubic log_e_of_log_P(log_P, log_e);
+
+    // d(ln rho)/d(ln P) = P/(e+P) * de/dP = e/(e+P) * d(ln e)/d(ln P), integrated with Simpson's rule
+    auto dlog_rho = [&log_e_of_log_P](const double lP0, const double lP1) {
+        const int substeps = 4;
+        const double h = (lP1 - lP0) / substeps;
+        double integral = 0.;
+        for (int j = 0; j <= substeps; j++) {
+            double le, s;
+            log_e_of_log_P.evaluate(lP0 + j*h, le, s);
+            const double e = std::exp(le), P = std::exp(lP0 + j*h);
+            integral += (j == 0 || j == substeps ? 1. : (j % 2 == 1 ? 4. : 2.)) * e/(e+P) * s;
+        }
+        return integral * h / 3.;
+    };
+    auto make_node = [&log_e_of_log_P](const double lP, const double P, const double rho) {
+        double le, dle;
+        log_e_of_log_P.evaluate(lP, le, dle);
+        Node node;
+        node.P = P;
+        node.e = std::exp(le);
+        node.rho = rho;
+        return node;
+    };
+
+    // the rows of the table and the points of the grid uniform in log P in between
+    const double dlog_P = (log_P.back() - log_P.front()) / (points-1);
+    std::vector<Node> resampled_nodes;
+    unsigned int k = 1;
+    for (std::size_t j = 0; j < table.size(); j++) {
+        Node row = make_node(log_P[j], table[j].P, table[j].rho);
+        row.e = table[j].e;
+        resampled_nodes.push_back(row);
+        if (j == table.size()-1)
+            break;
+
+        // rho between the rows follows the first law, scaled such that it matches the next row
+        const double dlog_rho_table = std::log(table[j+1].rho) - std::log(table[j].rho);
+        const double dlog_rho_row = dlog_rho(log_P[j], log_P[j+1]);
+        for (; k < points-1 && log_P.front() + k*dlog_P < log_P[j+1]; k++) {
+            const double lP = log_P.front() + k*dlog_P;
+            if (lP - log_P[j] < 1e-3*dlog_P || log_P[j+1] - lP < 1e-3*dlog_P)
+                continue;   // too close to a row
+            const double fraction = dlog_rho_row > 0. ? dlog_rho(log_P[j], lP) / dlog_rho_row : (lP - log_P[j]) / (log_P[j+1] - log_P[j]);
+            resampled_nodes.push_back(make_node(lP, std::exp(lP), table[j].rho * std::exp(fraction * dlog_rho_table)));
+        }
+    }
+
+    nodes = resampled_nodes;
+    this->compute_derivatives();
+    this->build_index(P_index, &Node::P, points-1);
+    this->build_index(rho_index, &Node::rho, points-1);
+    resampled = true;
+
+    // the accuracy with respect to the linear interpolation of the original table, at the rows and in the middle of the intervals
+    double max_dev_e = 0., max_dev_rho = 0., max_dev_P = 0.;
+    for (std::size_t j = 0; j < table.size(); j++) {
+        for (int half = 0; half < (j+1 < table.size() ? 2 : 1); half++) {
+            const Node& row = table[j];
+            const double P = half ? (row.P + table[j+1].P)/2. : row.P;
+            const double e = half ? (row.e + table[j+1].e)/2. : row.e;
+            const double rho = half ? (row.rho + table[j+1].rho)/2. : row.rho;
+            max_dev_e = std::max(max_dev_e, std::fabs(this->get_e_from_P(P) - e) / e);
+            max_dev_rho = std::max(max_dev_rho, std::fabs(this->get_rho_from_P(P) - rho) / rho);
+            max_dev_P = std::max(max_dev_P, std::fabs(this->get_P_from_rho(rho, 0.) - P) / P);
+        }
+    }
+    std::cout << "resampled EoS table to " << nodes.size() << " nodes, max. relative deviation from the table: e(P) " << max_dev_e
+                << ", rho(P) " << max_dev_rho << ", P(rho) " << max_dev_P << std::endl;
 }
 
 /* This expects as input P and will give rho, epsilon as output through reference
@@ -255,27 +845,21 @@ bool EoStable::load_from_file(const std::string filename) {
  *  otherwise simple linear interpolation is used to obtain rho, epsilon */
 void EoStable::callEOS(double& rho, double& epsilon, const double P) {
 
-	// use P to scan the EOS table (iterate from the top first because we start at high P_tablesures):
-	unsigned int table_len = P_table.size();
-	double e_tot_tmp = 0.0;
-
-
-	if (P < P_table[0]) { // we are outside the validity range of the table. Return zero
+	if (P < nodes[0].P) { // we are outside the validity range of the table. Return zero
 		rho = 0.;
 		epsilon = 0.;
 		return;
 	}
 
-	// search the table from the smaller values on first
-	for (unsigned int i = 1; i<table_len; i++) {
-		if (P_table[i] > P) {
-			// the correct value is between the i-1th index and the ith index:
-			// interpolate linearily between them:
-			rho = rho_table[i-1] + (rho_table[i] - rho_table[i-1]) / (P_table[i] - P_table[i-1]) * (P - P_table[i-1]);
-			e_tot_tmp = e_table[i-1] + (e_table[i] - e_table[i-1]) / (P_table[i] - P_table[i-1]) * (P - P_table[i-1]);
-			epsilon = e_tot_tmp/rho - 1.0;	// re-arrange to get epsilon. e=rho*(1+epsilon)
-			return;
-		}
+	std::size_t i = this->upper_index(&Node::P, P);
+	if (i < nodes.size()) {
+		// the correct value is between the i-1th index and the ith index:
+		// interpolate linearily between them:
+		const Node &lo = nodes[i-1], &hi = nodes[i];
+		rho = lo.rho + (hi.rho - lo.rho) / (hi.P - lo.P) * (P - lo.P);
+		double e_tot_tmp = lo.e + (hi.e - lo.e) / (hi.P - lo.P) * (P - lo.P);
+		epsilon = e_tot_tmp/rho - 1.0;	// re-arrange to get epsilon. e=rho*(1+epsilon)
+		return;
 	}
 	// return 0. outside the validity
     rho = 0.;
@@ -287,143 +871,300 @@ void EoStable::callEOS(double& rho, double& epsilon, const double P) {
  * If we are below or above the densities in rho, 0. is returned
  *  otherwise simple linear interpolation is used to obtain P from rho */
 double EoStable::get_P_from_rho(const double rho, const double epsilon) {
-    unsigned int table_len = rho_table.size();
+    unsigned int table_len = nodes.size();
 
     // if we are below the table return 0.
-    if (rho < rho_table[0]) {
+    if (rho < nodes[0].rho) {
         return 0.;
 	}
 
-	// search the table for the correct value
-	for (unsigned int i = 1; i<table_len; i++) {
-		if (rho_table[i] > rho) {
-			// the correct value is between the ith index and the i+1th index:
-			// interpolate linearily between them:
-			return P_table[i-1] + (P_table[i] - P_table[i-1]) / (rho_table[i] - rho_table[i-1]) * (rho - rho_table[i-1]);
-		}
+	std::size_t i = this->upper_index(&Node::rho, rho);
+	if (i < table_len) {
+		// the correct value is between the ith index and the i+1th index:
+		// interpolate linearily between them:
+		return nodes[i-1].P + (nodes[i].P - nodes[i-1].P) / (nodes[i].rho - nodes[i-1].rho) * (rho - nodes[i-1].rho);
 	}
     // if no value was found extrapolate linearly
-	return P_table[table_len-2] + (P_table[table_len-1] - P_table[table_len-2]) / (rho_table[table_len-1] - rho_table[table_len-2]) * (rho - rho_table[table_len-2]);
+	const Node &lo = nodes[table_len-2], &hi = nodes[table_len-1];
+	return lo.P + (hi.P - lo.P) / (hi.rho - lo.rho) * (rho - lo.rho);
 }
 
 // obtain P from an e_tot input
 double EoStable::get_P_from_e(const double e) {
-	unsigned int table_len = e_table.size();
+	unsigned int table_len = nodes.size();
 
     // if we are below the table interpolate between (0.,0.) and (rho[0], P[0])
-    if (e <= e_table[0]) {
-        return 0. + (P_table[0]-0.) / (e_table[0]-0.) * (e-0.);
+    if (e <= nodes[0].e) {
+        return 0. + (nodes[0].P-0.) / (nodes[0].e-0.) * (e-0.);
     }
 
-	// search the table for the correct value
-	for (unsigned int i = 1; i<table_len; i++) {
-		if (e_table[i] > e) {
-			// the correct value is between the ith index and the i+1th index:
-			// interpolate linearily between them:
-			return P_table[i-1] + (P_table[i] - P_table[i-1]) / (e_table[i] - e_table[i-1]) * (e - e_table[i-1]);
-		}
+	std::size_t i = this->upper_index(&Node::e, e);
+	if (i < table_len) {
+		// the correct value is between the ith index and the i+1th index:
+		// interpolate linearily between them:
+		return nodes[i-1].P + (nodes[i].P - nodes[i-1].P) / (nodes[i].e - nodes[i-1].e) * (e - nodes[i-1].e);
 	}
     // if no value was found extrapolate linearly
-	return P_table[table_len-2] + (P_table[table_len-1] - P_table[table_len-2]) / (e_table[table_len-1] - e_table[table_len-2]) * (e- e_table[table_len-2]);
+	const Node &lo = nodes[table_len-2], &hi = nodes[table_len-1];
+	return lo.P + (hi.P - lo.P) / (hi.e - lo.e) * (e - lo.e);
 }
 
 // obtain e from an P input
 double EoStable::get_e_from_P(const double P) {
-	unsigned int table_len = P_table.size();
+	unsigned int table_len = nodes.size();
 
     // if we are below the table interpolate between (0.,0.) and (rho[0], P[0])
-    if (P <= P_table[0]) {
-        return 0. + (e_table[0]-0.) / (P_table[0]-0.) * (P-0.);
+    if (P <= nodes[0].P) {
+        return 0. + (nodes[0].e-0.) / (nodes[0].P-0.) * (P-0.);
     }
 
-	// search the table for the correct value
-	for (unsigned int i = 1; i<table_len; i++) {
-		if (P_table[i] > P) {
-			// the correct value is between the ith index and the i+1th index:
-			// interpolate linearily between them:
-			return e_table[i-1] + (e_table[i] - e_table[i-1]) / (P_table[i] - P_table[i-1]) * (P - P_table[i-1]);
-		}
+	std::size_t i = this->upper_index(&Node::P, P);
+	if (i < table_len) {
+		// the correct value is between the ith index and the i+1th index:
+		// interpolate linearily between them:
+		return nodes[i-1].e + (nodes[i].e - nodes[i-1].e) / (nodes[i].P - nodes[i-1].P) * (P - nodes[i-1].P);
 	}
     // if no value was found extrapolate linearly
-	return e_table[table_len-2] + (e_table[table_len-1] - e_table[table_len-2]) / (P_table[table_len-1] - P_table[table_len-2]) * (P - P_table[table_len-2]);
+	const Node &lo = nodes[table_len-2], &hi = nodes[table_len-1];
+	return lo.e + (hi.e - lo.e) / (hi.P - lo.P) * (P - lo.P);
 }
 
 // obtain rho from an P input
 double EoStable::get_rho_from_P(const double P) {
-	unsigned int table_len = P_table.size();
+	unsigned int table_len = nodes.size();
 
     // if we are below the table interpolate between (0.,0.) and (rho[0], P[0])
-    if (P <= P_table[0]) {
-        return 0. + (rho_table[0]-0.) / (P_table[0]-0.) * (P-0.);
+    if (P <= nodes[0].P) {
+        return 0. + (nodes[0].rho-0.) / (nodes[0].P-0.) * (P-0.);
     }
 
-	// search the table for the correct value
-	for (unsigned int i = 1; i<table_len; i++) {
-		if (P_table[i] > P) {
-			// the correct value is between the ith index and the i+1th index:
-			// interpolate linearily between them:
-			return rho_table[i-1] + (rho_table[i] - rho_table[i-1]) / (P_table[i] - P_table[i-1]) * (P - P_table[i-1]);
-		}
+	std::size_t i = this->upper_index(&Node::P, P);
+	if (i < table_len) {
+		// the correct value is between the ith index and the i+1th index:
+		// interpolate linearily between them:
+		return nodes[i-1].rho + (nodes[i].rho - nodes[i-1].rho) / (nodes[i].P - nodes[i-1].P) * (P - nodes[i-1].P);
 	}
     // if no value was found extrapolate linearly
-	return rho_table[table_len-2] + (rho_table[table_len-1] - rho_table[table_len-2]) / (P_table[table_len-1] - P_table[table_len-2]) * (P - P_table[table_len-2]);
+	const Node &lo = nodes[table_len-2], &hi = nodes[table_len-1];
+	return lo.rho + (hi.rho - lo.rho) / (hi.P - lo.P) * (P - lo.P);
 }
 
-// obtain dP/drho from a rho input
-double EoStable::dP_drho(const double rho, const double epsilon) {
-	// search the table for the correct value:
-	unsigned int table_len = rho_table.size();
-
-    //assert(rho_in < rho[table_len-2]); // out of range will return 0.
-    if(rho < rho_table[1]) {
-        double dP1 = (P_table[2]-P_table[1])/(rho_table[2]-rho_table[1])/2. + (P_table[1] - P_table[0])/(rho_table[1]-rho_table[0])/2.;
-        return 0. + dP1 / (rho_table[1] - 0.) * (rho - 0.);
-    }
-
-	for (unsigned int i = 2; i<table_len; i++) {
-		// scan for the first matching rho
-		if (rho_table[i] > rho) {
-            // estimate derivative at point i-1 and i
-            double dP1 = (P_table[i]-P_table[i-1])/(rho_table[i]-rho_table[i-1])/2. + (P_table[i-1] - P_table[i-2])/(rho_table[i-1]-rho_table[i-2])/2.;
-            double dP2 = (P_table[i+1]-P_table[i])/(rho_table[i+1]-rho_table[i])/2. + (P_table[i] - P_table[i-1])/(rho_table[i]-rho_table[i-1])/2.;
-            return dP1 + (dP2-dP1)/(rho_table[i]- rho_table[i-1]) * (rho - rho_table[i-1]);
-		}
-	}
-    // if no value was found return 0.
-    return 0.;
+void EoStable::P_intervals(const double* P, std::size_t* intervals, const std::size_t n) const {
+    const std::size_t table_len = nodes.size();
+    std::size_t hint = 1;
+    for (std::size_t k = 0; k < n; k++) {
+        const double x = P[k];
+        if (!(x > nodes[0].P) || table_len < 2) {
+            intervals[k] = 0;
+            continue;
+        }
+        if (resampled) {
+            intervals[k] = this->upper_index(P_index, &Node::P, x);
+            continue;
+        }
+        // the pressures of a trajectory change monotonically, so mostly the interval of the previous point or a neighbour is right
+        std::size_t i = hint;
+        if (!(nodes[i-1].P <= x && (i == table_len || nodes[i].P > x))) {
+            if (i > 1 && nodes[i-2].P <= x && nodes[i-1].P > x)
+                i--;
+            else if (i < table_len && nodes[i].P <= x && (i+1 == table_len || nodes[i+1].P > x))
+                i++;
+            else
+                i = std::upper_bound(nodes.begin() + 1, nodes.end(), x, [](const double x, const Node& node) { return x < node.P; }) - nodes.begin();
+        }
+        intervals[k] = hint = i;
+    }
 }
 
-/* This expects as input rho, epsilon and returns dP/de
- * according to the tabulated EoS
- * If we are below or above the energies in e, 0. is returned
- *  otherwise simple linear interpolation is used to obtain P from e */
-double EoStable::dP_de(const double e) {
-    // search the table for the correct value:
-    unsigned int table_len = e_table.size();
+namespace {
 
-    if(e < e_table[1])
-        return 0.;
+/* The pressures are processed in blocks of this size: first the intervals are found and the nodes are gathered,
+ *  then the values are interpolated in a loop over contiguous arrays, which the compiler vectorizes */
+const std::size_t batch_block = 256;
+
+/* the point (0, 0, 0), to which get_e_from_P and get_rho_from_P interpolate below the table */
+const EoStable::Node origin_node = {0., 0., 0., 0.};
+
+/* The start and the differences of P and x over the intervals of a block */
+struct IntervalBlock {
+    double P0[batch_block], dP[batch_block], x0[batch_block], dx[batch_block];
+};
+
+/* lo.x + (hi.x - lo.x) / (hi.P - lo.P) * (P - lo.P) as in the single point functions */
+inline void interpolate_block(const IntervalBlock& block, const double* P, double* x, const std::size_t m) {
+    #pragma omp simd
+    for (std::size_t k = 0; k < m; k++)
+        x[k] = block.x0[k] + block.dx[k] / block.dP[k] * (P[k] - block.P0[k]);
+}
+
+}
+
+/* The same formulas as in get_e_from_P: below the table the interval is the one from the origin to the first node,
+ *  above the table the last interval is extrapolated */
+void EoStable::e_from_P_batch(const double* P, double* e, const std::size_t n) {
+    std::size_t intervals[batch_block];
+    IntervalBlock block;
+    const std::size_t last = nodes.size()-1;
+    for (std::size_t k0 = 0; k0 < n; k0 += batch_block) {
+        const std::size_t m = std::min(batch_block, n - k0);
+        this->P_intervals(P + k0, intervals, m);
+        for (std::size_t k = 0; k < m; k++) {
+            const std::size_t i = std::min(intervals[k], last);
+            const Node &lo = (i > 0 ? nodes[i-1] : origin_node), &hi = nodes[i];
+            block.P0[k] = lo.P;  block.dP[k] = hi.P - lo.P;
+            block.x0[k] = lo.e;  block.dx[k] = hi.e - lo.e;
+        }
+        interpolate_block(block, P + k0, e + k0, m);
+    }
+}
+
+/* The lanes follow different stars, so a single hint would change between them on every call */
+void EoStable::e_from_P_lanes(const double* P, double* e, std::size_t* hints, const std::size_t n) {
+    const std::size_t table_len = nodes.size();
+    for (std::size_t k = 0; k < n; k++) {
+        if (P[k] <= nodes[0].P) {
+            e[k] = 0. + (nodes[0].e-0.) / (nodes[0].P-0.) * (P[k]-0.);
+            continue;
+        }
+        const std::size_t i = this->upper_index(&Node::P, P[k], hints[k]);
+        if (i < table_len) {
+            e[k] = nodes[i-1].e + (nodes[i].e - nodes[i-1].e) / (nodes[i].P - nodes[i-1].P) * (P[k] - nodes[i-1].P);
+            continue;
+        }
+        const Node &lo = nodes[table_len-2], &hi = nodes[table_len-1];
+        e[k] = lo.e + (hi.e - lo.e) / (hi.P - lo.P) * (P[k] - lo.P);
+    }
+}
 
-    for (unsigned int i = 2; i<table_len; i++) {
-        // scan for the first matching e
-        if (e_table[i] > e) {
-            // estimate derivative at point i-1 and i
-            double dP1 = (P_table[i]-P_table[i-1])/(e_table[i]-e_table[i-1])/2. + (P_table[i-1] - P_table[i-2])/(e_table[i-1]-e_table[i-2])/2.;
-            double dP2 = (P_table[i+1]-P_table[i])/(e_table[i+1]-e_table[i])/2. + (P_table[i] - P_table[i-1])/(e_table[i]-e_table[i-1])/2.;
-            return dP1 + (dP2-dP1)/(e_table[i]- e_table[i-1]) * (e - e_table[i-1]);
+void EoStable::rho_from_P_batch(const double* P, double* rho, const std::size_t n) {
+    std::size_t intervals[batch_block];
+    IntervalBlock block;
+    const std::size_t last = nodes.size()-1;
+    for (std::size_t k0 = 0; k0 < n; k0 += batch_block) {
+        const std::size_t m = std::min(batch_block, n - k0);
+        this->P_intervals(P + k0, intervals, m);
+        for (std::size_t k = 0; k < m; k++) {
+            const std::size_t i = std::min(intervals[k], last);
+            const Node &lo = (i > 0 ? nodes[i-1] : origin_node), &hi = nodes[i];
+            block.P0[k] = lo.P;  block.dP[k] = hi.P - lo.P;
+            block.x0[k] = lo.rho;  block.dx[k] = hi.rho - lo.rho;
         }
+        interpolate_block(block, P + k0, rho + k0, m);
+    }
+}
+
+/* The same as callEOS: rho = epsilon = 0 outside of the table. At the first node, callEOS interpolates in the first interval.
+ * Outside of the table the first interval is interpolated and the result is replaced by 0 */
+void EoStable::callEOS_batch(const double* P, double* rho, double* epsilon, const std::size_t n) {
+    std::size_t intervals[batch_block];
+    IntervalBlock rho_block, e_block;
+    double e[batch_block];
+    const std::size_t table_len = nodes.size();
+    if (table_len < 2) {
+        std::fill(rho, rho + n, 0.);
+        std::fill(epsilon, epsilon + n, 0.);
+        return;
+    }
+    for (std::size_t k0 = 0; k0 < n; k0 += batch_block) {
+        const std::size_t m = std::min(batch_block, n - k0);
+        this->P_intervals(P + k0, intervals, m);
+        for (std::size_t k = 0; k < m; k++) {
+            if (intervals[k] == 0 && P[k0+k] == nodes[0].P)
+                intervals[k] = 1;
+            const std::size_t i = (intervals[k] > 0 && intervals[k] < table_len ? intervals[k] : 1);
+            const Node &lo = nodes[i-1], &hi = nodes[i];
+            rho_block.P0[k] = e_block.P0[k] = lo.P;
+            rho_block.dP[k] = e_block.dP[k] = hi.P - lo.P;
+            rho_block.x0[k] = lo.rho;  rho_block.dx[k] = hi.rho - lo.rho;
+            e_block.x0[k] = lo.e;  e_block.dx[k] = hi.e - lo.e;
+        }
+        interpolate_block(rho_block, P + k0, rho + k0, m);
+        interpolate_block(e_block, P + k0, e, m);
+        for (std::size_t k = 0; k < m; k++) {
+            const bool inside = (intervals[k] > 0 && intervals[k] < table_len);
+            epsilon[k0+k] = inside ? e[k]/rho[k0+k] - 1.0 : 0.;
+            rho[k0+k] = inside ? rho[k0+k] : 0.;
+        }
+    }
+}
+
+/* This expects as input rho and returns dP/drho (epsilon is ignored)
+ * according to the tabulated EoS
+ * The derivatives at the nodes (see compute_derivatives) are interpolated linearly,
+ *  outside of the table the derivative at the first or last node is returned */
+double EoStable::dP_drho(const double rho, const double epsilon) {
+    if (rho <= nodes[0].rho)
+        return node_dP_drho[0];
+
+    std::size_t i = this->upper_index(&Node::rho, rho);
+    if (i < nodes.size()) {
+        const Node &lo = nodes[i-1], &hi = nodes[i];
+        return node_dP_drho[i-1] + (node_dP_drho[i] - node_dP_drho[i-1])/(hi.rho - lo.rho) * (rho - lo.rho);
     }
-    return 0.;
+    return node_dP_drho.back();
 }
 
-double EoStable::min_P() {
-    return this->P_table.at(0);
+/* This gives the same values as get_e_from_P, get_rho_from_P, dP_de and dP_drho,
+ *  but the interval of P is found only once and all quantities are interpolated in it */
+EoSQuantities EoStable::query(const double P) {
+    const std::size_t table_len = nodes.size();
+    EoSQuantities q;
+
+    // if we are below the table interpolate e and rho between (0.,0.) and the first row
+    if (P <= nodes[0].P) {
+        q.e = 0. + (nodes[0].e-0.) / (nodes[0].P-0.) * (P-0.);
+        q.rho = 0. + (nodes[0].rho-0.) / (nodes[0].P-0.) * (P-0.);
+        q.epsilon = q.rho > 0. ? q.e/q.rho - 1. : 0.;
+        q.dP_de = nodes[0].dP_de;
+        q.dP_drho = node_dP_drho[0];
+        return q;
+    }
+
+    // above the table e and rho are extrapolated linearly, the derivatives are those of the last node
+    std::size_t i = this->upper_index(&Node::P, P);
+    const Node &lo = (i < table_len ? nodes[i-1] : nodes[table_len-2]), &hi = (i < table_len ? nodes[i] : nodes[table_len-1]);
+    q.e = lo.e + (hi.e - lo.e) / (hi.P - lo.P) * (P - lo.P);
+    q.rho = lo.rho + (hi.rho - lo.rho) / (hi.P - lo.P) * (P - lo.P);
+    q.epsilon = q.rho > 0. ? q.e/q.rho - 1. : 0.;
+    if (i < table_len) {
+        q.dP_de = lo.dP_de + (hi.dP_de - lo.dP_de)/(hi.e - lo.e) * (q.e - lo.e);
+        q.dP_drho = node_dP_drho[i-1] + (node_dP_drho[i] - node_dP_drho[i-1])/(hi.rho - lo.rho) * (q.rho - lo.rho);
+    } else {
+        q.dP_de = hi.dP_de;
+        q.dP_drho = node_dP_drho.back();
+    }
+    return q;
 }
-double EoStable::min_rho() {
-    return this->rho_table.at(0);
+
+/* This expects as input e and returns dP/de
+ * according to the tabulated EoS
+ * The derivatives at the nodes (see compute_derivatives) are interpolated linearly,
+ *  outside of the table the derivative at the first or last node is returned */
+double EoStable::dP_de(const double e) {
+    if (e <= nodes[0].e)
+        return nodes[0].dP_de;
+
+    std::size_t i = this->upper_index(&Node::e, e);
+    if (i < nodes.size()) {
+        const Node &lo = nodes[i-1], &hi = nodes[i];
+        return lo.dP_de + (hi.dP_de - lo.dP_de)/(hi.e - lo.e) * (e - lo.e);
+    }
+    return nodes.back().dP_de;
 }
-double EoStable::min_e() {
-    return this->e_table.at(0);
+
+/* This gives the sound speed c_s = sqrt(dP/de) at the pressure P, from dP/de interpolated linearly between the nodes */
+double EoStable::sound_speed(const double P) {
+    double dP_de = nodes.back().dP_de;
+    if (P <= nodes[0].P)
+        dP_de = nodes[0].dP_de;
+    else {
+        std::size_t i = this->upper_index(&Node::P, P);
+        if (i < nodes.size()) {
+            const Node &lo = nodes[i-1], &hi = nodes[i];
+            dP_de = lo.dP_de + (hi.dP_de - lo.dP_de)/(hi.P - lo.P) * (P - lo.P);
+        }
+    }
+    return std::sqrt(std::max(dP_de, 0.));
 }
 
 /*
@@ -0,0 +1,216 @@
+#include "eos_registry.hpp"
+
+#include <sys/stat.h>   // for stat, the size and modification time of the tables
+#include <sys/mman.h>   // for mmap of the binary cache
+#include <fcntl.h>      // for open
+#include <unistd.h>     // for close, getpid
+#include <filesystem>   // for the tables in a directory
+
+using namespace FBS;
+
+namespace {
+
+/* The header of the cache file, followed by n_nodes EoStable::Node */
+struct CacheHeader {
+    char magic[8];
+    std::uint64_t version;
+    std::uint64_t node_size;
+    std::uint64_t n_nodes;
+    std::uint64_t format_fingerprint;   // see EoSTableFormat::fingerprint
+    std::uint64_t reserved;
+    std::uint64_t source_size;      // the size of the table in bytes
+    std::int64_t source_mtime;      // the modification time of the table in ns
+};
+
+const char cache_magic[8] = {'F', 'B', 'S', 'E', 'o', 'S', 'T', 'B'};
+const std::uint64_t cache_version = 3;
+static_assert(sizeof(CacheHeader) % alignof(EoStable::Node) == 0, "the nodes in the cache have to be aligned");
+
+/* Gives the size and modification time of a file, false if it doesn't exist */
+bool file_stamp(const std::string& filename, std::uint64_t& size, std::int64_t& mtime) {
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0)
+        return false;
+    size = st.st_size;
+    mtime = (std::int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+}
+
+EoSRegistry::EoSRegistry() : use_cache(true) {
+    this->add("EOS_DD2",    "EOS_tables/eos_HS_DD2_with_electrons.beta");
+    this->add("EOS_APR",    "EOS_tables/eos_SRO_APR_SNA_version.beta");
+    this->add("EOS_KDE0v1", "EOS_tables/eos_SRO_KDE0v1_SNA_version.beta");
+    this->add("EOS_LNS",    "EOS_tables/eos_SRO_LNS_SNA_version.beta");
+    this->add("EOS_FSG",    "EOS_tables/eos_HS_FSG_with_electrons.beta");
+}
+
+EoSRegistry& EoSRegistry::instance() {
+    static EoSRegistry registry;
+    return registry;
+}
+
+void EoSRegistry::add(const std::string& name, const std::string& filename, const EoSTableFormat& format,
+                        const unsigned int resample_points, const bool use_hint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries[name];
+    if(entry.filename != filename || entry.format.fingerprint() != format.fingerprint()
+            || entry.resample_points != resample_points || entry.use_hint != use_hint)
+        entry.table.reset();
+    entry.filename = filename;
+    entry.format = format;
+    entry.resample_points = resample_points;
+    entry.use_hint = use_hint;
+}
+
+std::shared_ptr<EoStable> EoSRegistry::load_entry(const Entry& entry) const {
+    std::shared_ptr<EoStable> table = load(entry.filename, entry.format, use_cache);
+    if(entry.resample_points > 0)
+        table->resample_log_uniform(entry.resample_points);
+    table->set_use_hint(entry.use_hint);
+    table->freeze();
+    return table;
+}
+
+/* The tables are loaded without holding the lock, the errors are collected and the first one is thrown after the loop */
+std::vector<std::string> EoSRegistry::add_directory(const std::string& directory, const EoSTableFormat& format, const std::string& extension,
+                        const unsigned int resample_points, const bool use_hint) {
+    std::vector<std::filesystem::path> files;
+    for(const auto& file : std::filesystem::directory_iterator(directory)) {
+        if(file.is_regular_file() && file.path().extension() == extension)
+            files.push_back(file.path());
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<Entry> added(files.size());
+    std::vector<std::exception_ptr> errors(files.size());
+    #pragma omp parallel for schedule(dynamic)
+    for(unsigned int i = 0; i < files.size(); i++) {
+        try {
+            added[i] = Entry{files[i].string(), format, resample_points, use_hint, std::shared_ptr<EoStable>()};
+            added[i].table = load_entry(added[i]);
+        }
+        catch(...) {
+            errors[i] = std::current_exception();
+        }
+    }
+    for(auto it = errors.begin(); it != errors.end(); ++it) {
+        if(*it)
+            std::rethrow_exception(*it);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> names;
+    for(unsigned int i = 0; i < files.size(); i++) {
+        entries[files[i].stem().string()] = added[i];
+        names.push_back(files[i].stem().string());
+    }
+    return names;
+}
+
+/* The table is loaded while the lock is held, so that threads asking for the same name at the same time load it only once */
+std::shared_ptr<EoStable> EoSRegistry::get(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(name);
+    if(it == entries.end())
+        return std::shared_ptr<EoStable>();
+    Entry& entry = it->second;
+    if(entry.table)
+        return entry.table;
+
+    entry.table = load_entry(entry);
+    return entry.table;
+}
+
+std::vector<std::string> EoSRegistry::names() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> list;
+    for(auto it = entries.begin(); it != entries.end(); ++it)
+        list.push_back(it->first);
+    return list;
+}
+
+void EoSRegistry::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto it = entries.begin(); it != entries.end(); ++it)
+        it->second.table.reset();
+}
+
+std::string EoSRegistry::cache_file(const std::string& filename) {
+    return filename + ".cache";
+}
+
+std::shared_ptr<EoStable> EoSRegistry::load(const std::string& filename, const EoSTableFormat& format, const bool use_cache) {
+    std::shared_ptr<EoStable> table;
+    if(use_cache)
+        table = load_cache(filename, format);
+    if(!table) {
+        table = std::make_shared<EoStable>(filename, format);
+        if(use_cache)
+            save_cache(*table, filename, format);
+    }
+    return table;
+}
+
+bool EoSRegistry::save_cache(const EoStable& table, const std::string& filename, const EoSTableFormat& format) {
+    CacheHeader header;
+    std::memcpy(header.magic, cache_magic, sizeof(header.magic));
+    header.version = cache_version;
+    header.node_size = sizeof(EoStable::Node);
+    header.n_nodes = table.get_nodes().size();
+    header.format_fingerprint = format.fingerprint();
+    header.reserved = 0;
+    if(!file_stamp(filename, header.source_size, header.source_mtime))
+        return false;
+
+    const std::string cachename = cache_file(filename);
+    const std::string tmpname = cachename + "." + std::to_string(getpid());
+    std::ofstream outfile(tmpname, std::ios::binary);
+    if(!outfile.is_open())
+        return false;
+    outfile.write((const char*)&header, sizeof(header));
+    outfile.write((const char*)table.get_nodes().data(), header.n_nodes * sizeof(EoStable::Node));
+    outfile.close();
+    if(!outfile || std::rename(tmpname.c_str(), cachename.c_str()) != 0) {
+        std::remove(tmpname.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<EoStable> EoSRegistry::load_cache(const std::string& filename, const EoSTableFormat& format) {
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    if(!file_stamp(filename, source_size, source_mtime))
+        return std::shared_ptr<EoStable>();
+
+    const std::string cachename = cache_file(filename);
+    int fd = open(cachename.c_str(), O_RDONLY);
+    if(fd < 0)
+        return std::shared_ptr<EoStable>();
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return std::shared_ptr<EoStable>();
+    }
+    const std::size_t length = st.st_size;
+    void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping stays valid
+    if(data == MAP_FAILED)
+        return std::shared_ptr<EoStable>();
+
+    std::shared_ptr<EoStable> table;
+    const CacheHeader* header = (const CacheHeader*)data;
+    if(std::memcmp(header->magic, cache_magic, sizeof(cache_magic)) == 0 && header->version == cache_version
+            && header->node_size == sizeof(EoStable::Node) && header->n_nodes > 0
+            && header->source_size == source_size && header->source_mtime == source_mtime
+            && header->format_fingerprint == format.fingerprint()
+            && length == sizeof(CacheHeader) + header->n_nodes * sizeof(EoStable::Node)) {
+        // the nodes follow the 64 byte header, which keeps them aligned to 32 bytes within the page-aligned mapping
+        const EoStable::Node* begin = (const EoStable::Node*)((const char*)data + sizeof(CacheHeader));
+        table = std::make_shared<EoStable>(std::vector<EoStable::Node>(begin, begin + header->n_nodes));
+    }
+    munmap(data, length);
+    return table;
+}
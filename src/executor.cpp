@@ -0,0 +1,190 @@
+#include "executor.hpp"
+
+using namespace FBS;
+
+namespace {
+
+/* The executor and index of the worker that runs on this thread */
+thread_local const Executor* current_executor = nullptr;
+thread_local int current_worker = -1;
+
+/* The state of the tasks of submit_range, the last task to finish sets the promise */
+struct RangeState {
+    std::atomic<std::size_t> remaining;
+    std::promise<void> done;
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::function<void(std::size_t)> f;
+    std::vector<std::size_t> order;     // for submit_ordered
+    std::atomic<std::size_t> next;
+};
+
+/* runs the task and sets the promise if it was the last one */
+void run_range_task(RangeState& state, const std::size_t i) {
+    try {
+        state.f(i);
+    }
+    catch(...) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(!state.error)
+            state.error = std::current_exception();
+    }
+    if(--state.remaining == 0) {
+        if(state.error)
+            state.done.set_exception(state.error);
+        else
+            state.done.set_value();
+    }
+}
+
+}
+
+Executor& Executor::instance() {
+#ifdef _OPENMP
+    static Executor executor(omp_get_max_threads());
+#else
+    static Executor executor(std::thread::hardware_concurrency());
+#endif
+    return executor;
+}
+
+Executor::Executor(unsigned int n_workers) : pending(0), next_queue(0), stopping(false) {
+    n_workers = std::max(n_workers, 1u);
+    for(unsigned int i = 0; i < n_workers; i++)
+        queues.emplace_back(new Queue());
+    for(unsigned int i = 0; i < n_workers; i++)
+        workers.emplace_back(&Executor::work, this, i);
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto it = workers.begin(); it != workers.end(); ++it)
+        it->join();
+}
+
+int Executor::worker_index() const {
+    return current_executor == this ? current_worker : -1;
+}
+
+void Executor::push(Task task) {
+    {
+        // pending is counted first and under the lock, so that a worker can't miss it between checking it and going to sleep
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        pending++;
+    }
+    const int worker = this->worker_index();
+    Queue& queue = *queues[worker >= 0 ? worker : next_queue++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+std::future<void> Executor::submit(Task task) {
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> future = packaged->get_future();
+    this->push([packaged]() { (*packaged)(); });
+    return future;
+}
+
+std::future<void> Executor::submit_range(const std::size_t n, std::function<void(std::size_t)> f) {
+    auto state = std::make_shared<RangeState>();
+    state->remaining = n;
+    state->f = std::move(f);
+    std::future<void> future = state->done.get_future();
+    if(n == 0) {
+        state->done.set_value();
+        return future;
+    }
+    for(std::size_t i = 0; i < n; i++)
+        this->push([state, i]() { run_range_task(*state, i); });
+    return future;
+}
+
+std::future<void> Executor::submit_ordered(const std::vector<std::size_t>& order, std::function<void(std::size_t)> f) {
+    auto state = std::make_shared<RangeState>();
+    state->remaining = order.size();
+    state->f = std::move(f);
+    state->order = order;
+    state->next = 0;
+    std::future<void> future = state->done.get_future();
+    if(order.empty()) {
+        state->done.set_value();
+        return future;
+    }
+    // the tasks are interchangeable, whichever runs first takes the next index of the order
+    for(std::size_t j = 0; j < order.size(); j++)
+        this->push([state]() { run_range_task(*state, state->order[state->next++]); });
+    return future;
+}
+
+bool Executor::run_one(const unsigned int worker) {
+    Task task;
+    // the newest task of the own queue, then the oldest task of the other queues
+    for(unsigned int k = 0; k < queues.size() && !task; k++) {
+        Queue& queue = *queues[(worker + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty())
+            continue;
+        if(k == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if(!task)
+        return false;
+    pending--;
+    task();
+    return true;
+}
+
+void Executor::work(const unsigned int worker) {
+    current_executor = this;
+    current_worker = worker;
+    while(true) {
+        if(this->run_one(worker))
+            continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this]() { return stopping || pending > 0; });
+        if(stopping && pending == 0)
+            return;
+    }
+}
+
+void Executor::wait(std::future<void>& future) {
+    const int worker = this->worker_index();
+    if(worker < 0) {
+        future.wait();
+        return;
+    }
+    // the tasks the worker runs in the meantime may take longer than the awaited ones, this only delays the return
+    while(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if(!this->run_one(worker))
+            future.wait_for(std::chrono::microseconds(100));
+    }
+}
+
+void Executor::wait_all(std::vector<std::future<void>>& futures) {
+    std::exception_ptr error;
+    for(auto it = futures.begin(); it != futures.end(); ++it) {
+        this->wait(*it);
+        try {
+            it->get();
+        }
+        catch(...) {
+            if(!error)
+                error = std::current_exception();
+        }
+    }
+    if(error)
+        std::rethrow_exception(error);
+}
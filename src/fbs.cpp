@@ -38,6 +38,32 @@ const integrator::Event FermionBosonStar::P_min_reached = integrator::Event([](c
                                                                                                 { return (y[4] <= std::max(P_ns_min, ((FermionBosonStar*)params)->EOS->min_P())); }, false, "P_min_reached", 1e-5);
 
 
+/*   FermionBosonStarDivergenceObserver   */
+const double FermionBosonStarDivergenceObserver::Psi_sample = 1e-3;
+
+void FermionBosonStarDivergenceObserver::reset() {
+    r = 0.; Psi = 0.; K = 0.;
+    found = false;
+    last_r = -1.; last_k = 0.; K_now = 0.; above = false;
+}
+
+void FermionBosonStarDivergenceObserver::observe(const double r, const vector& y, const vector& dy) {
+    const double a = y[0], alpha = y[1], phi = y[2];
+    const double k2 = fbs.mu*fbs.mu + fbs.lambda*phi*phi - fbs.omega*fbs.omega/alpha/alpha;
+    const double k = k2 > 0. ? a*std::sqrt(k2) : 0.;
+    if (last_r >= 0.)
+        K_now += 0.5*(k + last_k)*(r - last_r);
+    last_r = r; last_k = k;
+
+    const bool now_above = phi*y[3] > 0. && std::abs(y[3]) > Psi_sample;
+    if (now_above && !this->above) {
+        this->r = r; this->Psi = y[3]; this->K = K_now;
+        this->found = true;
+    }
+    this->above = now_above;
+}
+
+
 /* This function gives the system of ODEs for the FBS star
  *  for the variables a, alpha, phi, Psi, and P
  *  taken from https://arxiv.org/pdf/2110.11997.pdf
@@ -45,10 +71,18 @@ const integrator::Event FermionBosonStar::P_min_reached = integrator::Event([](c
  *  This function is called by the integrator during the integration
  * */
 vector FermionBosonStar::dy_dr(const double r, const vector& vars) const {
+    return this->dy_dr(r, fixed_vector<5>(vars)).to_vector();
+}
+
+fixed_vector<5> FermionBosonStar::dy_dr(const double r, const fixed_vector<5>& vars) const {
+    return this->dy_dr(r, vars, *(this->EOS));
+}
+
+template <typename E>
+fixed_vector<5> FermionBosonStar::dy_dr(const double r, const fixed_vector<5>& vars, E& EoS) const {
 
     // rename input & class variables for simpler use
     const double a = vars[0]; const double alpha = vars[1]; const double phi = vars[2]; const double Psi = vars[3]; double P = vars[4];
-    EquationOfState& EoS = *(this->EOS);
 
     // define hydrodynamic quantities
     double etot = 0.;	// total energy density. Must be computes from P using the EoS
@@ -71,7 +105,14 @@ vector FermionBosonStar::dy_dr(const double r, const vector& vars) const {
     double dP_dr = -(etot + P)*dalpha_dr/alpha;
 
     // write the ODE values into output vector
-    return vector({da_dr, dalpha_dr, dPhi_dr, dPsi_dr, dP_dr});
+    return fixed_vector<5>({da_dr, dalpha_dr, dPhi_dr, dPsi_dr, dP_dr});
+}
+
+int FermionBosonStar::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    return dispatch_eos(*(this->EOS), [&](auto& EoS) {
+        const auto rhs = [this, &EoS](const double r, const fixed_vector<5>& y, const void*) { return this->dy_dr(r, y, EoS); };
+        return this->integrate_fixed<5>(rhs, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    });
 }
 
 
@@ -87,7 +128,7 @@ vector FermionBosonStar::get_initial_conditions(double r_init) const {
  *  and we can set it to zero. The convergence criterion is given by the phi_converged event. The function returns R_B_0 by reference.
  * If the condition is not fulfilled, the "convergence" can be forced (with the force boolean) by finding the last minimum of the phi field.
  * */
-int FermionBosonStar::find_bosonic_convergence(std::vector<integrator::step>& results, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOpts, double& R_B_0, bool force, double r_init, double r_end) const {
+int FermionBosonStar::find_bosonic_convergence(integrator::Trajectory& results, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOpts, double& R_B_0, bool force, double r_init, double r_end) const {
 
     if(this->phi_0 <= 0.)
         return -1;
@@ -118,7 +159,7 @@ int FermionBosonStar::find_bosonic_convergence(std::vector<integrator::step>& re
         // find the minimum in the phi field before it diverges
         int index_phi_converged = 1;
 
-        auto abs_phi_func = [&results] (int index) { return std::abs(results[index].second[2]); };
+        auto abs_phi_func = [&results] (int index) { return std::abs(results.y(index, 2)); };
         std::vector<int> abs_phi_minima({});
         int index_phi_global_min = 0;
         for (unsigned int i=1; i < results.size()-1; i++) {
@@ -133,21 +174,21 @@ int FermionBosonStar::find_bosonic_convergence(std::vector<integrator::step>& re
 
         // maybe the event didn't trigger because psi was too large?
         if(!force) {
-            auto y_at_phi_converged = results[index_phi_converged].second;
-            vector dy_at_phi_converged = this->dy_dr(results[index_phi_converged].first, y_at_phi_converged);
+            auto y_at_phi_converged = results.y(index_phi_converged);
+            vector dy_at_phi_converged = this->dy_dr(results.r(index_phi_converged), y_at_phi_converged);
             y_at_phi_converged[3] =0.;
-            if (!phi_converged.condition(results[index_phi_converged].first, 0., y_at_phi_converged, dy_at_phi_converged, (const void*)this)) {
+            if (!phi_converged.condition(results.r(index_phi_converged), 0., y_at_phi_converged, dy_at_phi_converged, (const void*)this)) {
                 return res; // no, phi doesn't get close to zero so we shouldn't artifically set it so
             }
         }
         // found a convergence for phi so restart at that point
-        results.erase(results.begin()+index_phi_converged, results.end()); // remove elements from integration
+        results.truncate(index_phi_converged); // remove elements from integration
 
         for (auto it = events.begin(); it != events.end(); ++it) // set events to active so that they don't trigger again in case they were active at the point of convergence
             it->active = true;
     }
 
-    R_B_0 = results[results.size()-1].first;
+    R_B_0 = results.r(results.size()-1);
     return res;
 }
 
@@ -161,7 +202,7 @@ int FermionBosonStar::find_bosonic_convergence(std::vector<integrator::step>& re
  *
  * Only call after omega is set to the corresponding value, otherwise this function is not useful.
  * */
-int FermionBosonStar::integrate_and_avoid_phi_divergence(std::vector<integrator::step>& results, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOpts, bool force, std::vector<int> additional_zero_indices, double r_init, double r_end)  {
+int FermionBosonStar::integrate_and_avoid_phi_divergence(integrator::Trajectory& results, std::vector<integrator::Event>& events, integrator::IntegrationOptions intOpts, bool force, std::vector<int> additional_zero_indices, double r_init, double r_end, Workspace* workspace)  {
 
     results.clear();
     int res;
@@ -185,22 +226,21 @@ int FermionBosonStar::integrate_and_avoid_phi_divergence(std::vector<integrator:
     }
 
     // now we can restart the integration
-    vector initial_conditions = results[results.size()-1].second;
+    vector initial_conditions = results.y(results.size()-1);
     initial_conditions[2] = 0.; initial_conditions[3] = 0.; // artificially set phi = Psi = 0
     for (auto it = additional_zero_indices.begin(); it != additional_zero_indices.end(); ++it)  // and any other specified, i.e. phi_1, dphi_1
         initial_conditions[*it] = 0.;
 
-    std::vector<integrator::step> additional_results;
+    Workspace local_workspace;
+    integrator::Trajectory& additional_results = (workspace ? *workspace : local_workspace).trajectory(1);
     events.push_back(FermionBosonStar::integration_converged);
-    double last_r = results[results.size()-1].first;
+    double last_r = results.r(results.size()-1);
     intOpts.clean_events = false;  // to stop the integrator from clearing the events
 
     res = this->integrate(additional_results, events, initial_conditions, intOpts, last_r, r_end);
 
-    // add the results together into one vector
-    results.reserve(results.size() + additional_results.size());
-    for(unsigned int i = 1; i < additional_results.size(); i++)     // skip the first element to avoid duplicates
-        results.push_back(additional_results[i]);
+    // add the results together into one trajectory
+    results.append(additional_results, 1);     // skip the first element to avoid duplicates
 
     events.pop_back();
     return res;
@@ -211,7 +251,7 @@ int FermionBosonStar::bisection_expand_range(double& omega_0, double& omega_1, i
     integrator::IntegrationOptions intOpts;
     intOpts.verbose = verbose - 1;
     std::vector<integrator::Event> events = {phi_negative, phi_positive, Psi_diverging};
-    std::vector<integrator::step> results_0, results_1;
+    integrator::Trajectory results_0, results_1;
 
     // if the desired number of roots is not given by the initial range adjust the range
     const int max_tries = 20;
@@ -227,6 +267,7 @@ int FermionBosonStar::bisection_expand_range(double& omega_0, double& omega_1, i
         if (verbose > 1)
             std::cout << tries << ": omega_0 now= " << this->omega << std::endl;
         this->integrate(results_0, events, this->get_initial_conditions(), intOpts);
+        this->omega_integrations++;
         n_roots_0 = events[0].steps.size() + events[1].steps.size() - 1; // number of roots is number of - to + crossings plus + to - crossings
         if(tries > max_tries)
             return -1;
@@ -240,6 +281,7 @@ int FermionBosonStar::bisection_expand_range(double& omega_0, double& omega_1, i
         if (verbose > 1)
             std::cout << tries << ": omega_1 now= " << this->omega << std::endl;
         this->integrate(results_1, events, this->get_initial_conditions(), intOpts);
+        this->omega_integrations++;
         n_roots_1 = events[0].steps.size() + events[1].steps.size() - 1; // number of roots is number of - to + crossings plus + to - crossings
         if(tries > max_tries)
             return -1;
@@ -261,16 +303,18 @@ int FermionBosonStar::bisection_find_mode(double& omega_0, double& omega_1, int
     integrator::IntegrationOptions intOpts;
     intOpts.verbose = verbose - 1;
     std::vector<integrator::Event> events = {phi_negative, phi_positive, Psi_diverging};
-    std::vector<integrator::step> results_0, results_1, results_mid;
+    integrator::Trajectory results_0, results_1, results_mid;
 
     // set the lower omega and integrate the ODEs:
     this->omega = omega_0;
     res = this->integrate(results_0, events, this->get_initial_conditions(), intOpts);
+    this->omega_integrations++;
     n_roots_0 = events[0].steps.size() + events[1].steps.size() - 1;    // number of roots is number of - to + crossings plus + to - crossings
 
     // set the upper omega and integrate the ODEs:
     this->omega = omega_1;
     res = this->integrate(results_1, events, this->get_initial_conditions(), intOpts);
+    this->omega_integrations++;
     n_roots_1 = events[0].steps.size() + events[1].steps.size() - 1;
 
     if(n_roots_0 == n_roots_1 || n_roots_0 > n_mode || n_mode > n_roots_1) {
@@ -290,6 +334,7 @@ int FermionBosonStar::bisection_find_mode(double& omega_0, double& omega_1, int
             break;
         this->omega = omega_mid;
         res = this->integrate(results_mid, events, this->get_initial_conditions(), intOpts);
+        this->omega_integrations++;
         n_roots_mid = events[0].steps.size() + events[1].steps.size() -1;   // number of roots is number of - to + crossings plus + to - crossings
 
         if (verbose> 1)
@@ -325,17 +370,19 @@ int FermionBosonStar::bisection_converge_through_infty_behavior(double omega_0,
     integrator::IntegrationOptions intOpts;
     intOpts.verbose = verbose - 1;
     std::vector<integrator::Event> events = {Psi_diverging};
-    std::vector<integrator::step> results_0, results_1, results_mid;
+    integrator::Trajectory results_0, results_1, results_mid;
 
     // find right behavior at infty ( Phi(r->infty) = 0 )
     int n_inft_0, n_inft_1, n_inft_mid; // store the sign of Phi at infinity (or at the last r-value)
     this->omega = omega_0;
     res = this->integrate(results_0, events, this->get_initial_conditions(), intOpts);
-    n_inft_0 = results_0[results_0.size()-1].second[2] > 0.;    // save if sign(Phi(inf)) is positive or negative
+    this->omega_integrations++;
+    n_inft_0 = results_0.y(results_0.size()-1, 2) > 0.;    // save if sign(Phi(inf)) is positive or negative
 
     this->omega = omega_1;
     res_1 = this->integrate(results_1, events, this->get_initial_conditions(), intOpts);
-    n_inft_1 = results_1[results_1.size()-1].second[2] > 0.;
+    this->omega_integrations++;
+    n_inft_1 = results_1.y(results_1.size()-1, 2) > 0.;
     if (verbose > 0)
         std::cout << "start with omega_0 =" << omega_0 << " with n_inft=" << n_inft_0 << " and omega_1=" << omega_1 << " with n_inft=" << n_inft_1 << std::endl;
 
@@ -349,9 +396,12 @@ int FermionBosonStar::bisection_converge_through_infty_behavior(double omega_0,
     steps = 0;
     while((omega_1 - omega_0)/omega_0 > delta_omega && steps < max_steps) { // iterate until accuracy in omega was reached or max number of steps exceeded
         omega_mid = (omega_0 + omega_1)/2.;
+        if (omega_mid == omega_0 || omega_mid == omega_1) // we reached floating point accuracy limits, delta_omega=1e-16 is below them
+            break;
         this->omega = omega_mid;
         res = this->integrate(results_mid, events, this->get_initial_conditions(), intOpts);
-        n_inft_mid = results_mid[results_mid.size()-1].second[2] > 0.;  // save if sign(Phi(inf)) is positive or negative
+        this->omega_integrations++;
+        n_inft_mid = results_mid.y(results_mid.size()-1, 2) > 0.;  // save if sign(Phi(inf)) is positive or negative
 
         if (verbose > 1)
             std::cout << steps << ": omega_mid = " << omega_mid  << " with n_inft= " << n_inft_mid << std::endl;
@@ -380,6 +430,95 @@ int FermionBosonStar::bisection_converge_through_infty_behavior(double omega_0,
     return 0.;
 }
 
+/* This function converges on omega like bisection_converge_through_infty_behavior, but uses more than the sign of phi where the integration stops.
+ * Outside of the star, the field is a superposition phi ~ (A exp(K) + B exp(-K))/r of a growing and a decaying solution with the WKB exponent
+ *  K = int k dr, and the integration diverges because A doesn't vanish exactly. A is a smooth function of omega with a simple root at the
+ *  eigenfrequency, and can be read off where the growing part dominates: ln|A| ~ ln|Psi| + ln(r) - K.
+ * K and this point are found with FermionBosonStarDivergenceObserver, well before the integration stops at Psi_diverging, where the diverging
+ *  field has already driven the metric far from its asymptotic values. Only the sign of phi is used if the observer didn't find it.
+ * The root of sign(phi) |A| is found with Brent's method (see utilities::brent_zeroin), which keeps a range with a sign change like the bisection,
+ *  but takes secant or inverse quadratic interpolation steps through the last values when they shrink the range fast enough,
+ *  and bisection steps otherwise. The resulting omega is chosen from the final range as in the bisection.
+ * */
+int FermionBosonStar::brent_converge_through_infty_behavior(double omega_0, double omega_1, int n_mode, int max_steps, double delta_omega, int verbose) {
+
+    int res, res_1;
+    int steps = 0;
+
+    integrator::IntegrationOptions intOpts;
+    intOpts.verbose = verbose - 1;
+    std::vector<integrator::Event> events = {Psi_diverging};
+    integrator::Trajectory results;
+    FermionBosonStarDivergenceObserver observer(*this);
+
+    // integrates with the given omega, sets whether phi is positive at the end of the integration and ln|A|, which is NaN if it is unknown
+    auto integrate_to_infty = [&] (double omega, int& n_inft, double& log_A) {
+        this->omega = omega;
+        observer.reset();
+        int res = this->integrate(results, events, this->get_initial_conditions(), intOpts, -1., -1., &observer);
+        this->omega_integrations++;
+        n_inft = results.y(results.size()-1, 2) > 0.;
+        log_A = observer.found ? std::log(std::abs(observer.Psi)) + std::log(observer.r) - observer.K : NAN;
+        return res;
+    };
+
+    int n_inft_0, n_inft_1;
+    double log_A_0, log_A_1;
+    res = integrate_to_infty(omega_0, n_inft_0, log_A_0);
+    res_1 = integrate_to_infty(omega_1, n_inft_1, log_A_1);
+    if (verbose > 0)
+        std::cout << "start with omega_0 =" << omega_0 << " with n_inft=" << n_inft_0 << " and omega_1=" << omega_1 << " with n_inft=" << n_inft_1 << std::endl;
+
+    if(res == integrator::endpoint_reached || res_1 == integrator::endpoint_reached) { // in this case psi didn't diverge, so we are probably not integrating to large enough r
+        this->r_end *= 1.5;
+        if (verbose > 1)
+            std::cout << "increased r_end to " << this->r_end << " and going deeper" <<  std::endl;
+        return bisection(omega_0, omega_1, n_mode, max_steps-steps, delta_omega, verbose);
+    }
+    if(n_inft_0 == n_inft_1)    // no sign change, leave it to the bisection, which ends at one side of the range
+        return this->bisection_converge_through_infty_behavior(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
+
+    // the signed amplitudes, relative to the larger one at the start so that they don't underflow, only the sign is used if A is unknown
+    const double log_A_ref = std::isnan(log_A_0) ? log_A_1 : (std::isnan(log_A_1) ? log_A_0 : std::max(log_A_0, log_A_1));
+    auto signed_amplitude = [log_A_ref] (int n_inft, double log_A) {
+        return (n_inft ? 1. : -1.) * (std::isnan(log_A) || std::isnan(log_A_ref) ? 1. : std::exp(std::max(log_A - log_A_ref, -700.)));
+    };
+
+    // b is the best estimate and a the other end of the range
+    double a = omega_0, b = omega_1;
+    double A_a = signed_amplitude(n_inft_0, log_A_0), A_b = signed_amplitude(n_inft_1, log_A_1);
+    const double rel_tol = 0.5*std::max(delta_omega, 2.*std::numeric_limits<double>::epsilon());
+    utilities::brent_zeroin([&] (double omega) {
+            int n_inft;
+            double log_A;
+            integrate_to_infty(omega, n_inft, log_A);
+            const double A = signed_amplitude(n_inft, log_A);
+            steps++;
+            if (verbose > 1)
+                std::cout << steps << ": omega = " << omega  << " with n_inft= " << n_inft << ", A = " << A << std::endl;
+            return A;
+        }, a, b, A_a, A_b, rel_tol, 0., max_steps);  // iterate until accuracy in omega was reached or max number of steps exceeded
+
+    // choose from the range like the bisection, the sign of the amplitude is that of phi
+    omega_0 = std::min(a, b); omega_1 = std::max(a, b);
+    n_inft_0 = (a < b ? A_a : A_b) > 0.; n_inft_1 = 1 - n_inft_0;
+    if (n_inft_1 > 0.)
+        this->omega = omega_1;
+    else
+        this->omega = omega_0;
+
+    if (verbose > 0)
+        std::cout << "After " << steps << " steps, chose " << omega << " out of omega_0 =" << omega_0 << " with n_inft=" << n_inft_0 << ", omega_1=" << omega_1 << " with n_inft=" << n_inft_1 << std::endl;
+
+    return 0.;
+}
+
+int FermionBosonStar::converge_through_infty_behavior(double omega_0, double omega_1, int n_mode, int max_steps, double delta_omega, int verbose) {
+    if (this->omega_solver == brent)
+        return this->brent_converge_through_infty_behavior(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
+    return this->bisection_converge_through_infty_behavior(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
+}
+
 /* This function tries to find the corresponding omega for a given mu, lambda, rho_0, phi_0
  * such that it is an eigenfrequency with a bisection algorithm.
  * The initial range is given by (omega_0, omega_1). First, the right number of zero crossings for (n_mode) is found
@@ -406,10 +545,75 @@ int FermionBosonStar::bisection(double omega_0, double omega_1, int n_mode, int
     if(result)
         return result;
 
-    result = this->bisection_converge_through_infty_behavior(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
+    result = this->converge_through_infty_behavior(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
     return result;
 }
 
+/* This function finds omega like the bisection function, but starts with a narrow range around omega_guess,
+ *  which is usually known from the neighbouring stars on a grid (see calc_rhophi_curves).
+ * The number of roots at the edges of the range tells whether the range contains the nth mode. If not,
+ *  the offending edge is moved 8 times further away from omega_guess, up to max_widenings times.
+ * When the range contains the mode, the bisection of the behavior at infinity starts from there, which saves
+ *  most of the steps of bisection_find_mode and bisection_converge_through_infty_behavior for a good guess
+ * */
+int FermionBosonStar::bisection_warm_start(double omega_guess, double rel_width, double omega_0, double omega_1, int n_mode, int max_steps, double delta_omega, int verbose) {
+
+    const int max_widenings = 4;
+
+    // if phi_0 = 0 then we don't need a bisection
+    if (this->phi_0 == 0.) {
+        this->omega = 0.;
+        return 0;
+    }
+    if (!(omega_guess > 0.) || !(rel_width > 0.))
+        return this->bisection(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
+
+    integrator::IntegrationOptions intOpts;
+    intOpts.verbose = verbose - 1;
+    std::vector<integrator::Event> events = {phi_negative, phi_positive, Psi_diverging};
+    integrator::Trajectory results;
+
+    auto n_roots = [&] (double omega) {
+        this->omega = omega;
+        this->integrate(results, events, this->get_initial_conditions(), intOpts);
+        this->omega_integrations++;
+        return (int)(events[0].steps.size() + events[1].steps.size()) - 1;    // number of roots is number of - to + crossings plus + to - crossings
+    };
+
+    double width_0 = std::min(rel_width, 0.5) * omega_guess, width_1 = width_0;
+    double omega_lower = omega_guess - width_0, omega_upper = omega_guess + width_1;
+    int n_roots_lower = n_roots(omega_lower), n_roots_upper = n_roots(omega_upper);
+
+    int widenings = 0;
+    while ((n_roots_lower > n_mode || n_roots_upper <= n_mode) && widenings < max_widenings) {
+        if (n_roots_lower > n_mode) {
+            width_0 = std::min(8.*width_0, 0.5*omega_guess);
+            omega_lower = omega_guess - width_0;
+            n_roots_lower = n_roots(omega_lower);
+        }
+        if (n_roots_upper <= n_mode) {
+            width_1 *= 8.;
+            omega_upper = omega_guess + width_1;
+            n_roots_upper = n_roots(omega_upper);
+        }
+        widenings++;
+    }
+    if (verbose > 0)
+        std::cout << "warm start with omega_guess = " << omega_guess << ": omega_0 = " << omega_lower << " with n_roots=" << n_roots_lower
+                    << " and omega_1 = " << omega_upper << " with n_roots=" << n_roots_upper << " after " << widenings << " widenings" << std::endl;
+
+    if (n_roots_lower > n_mode || n_roots_upper <= n_mode) // the guess was too far off, start over
+        return this->bisection(omega_0, omega_1, n_mode, max_steps, delta_omega, verbose);
+
+    int result = 0;
+    if (n_roots_upper - n_roots_lower > 1) // only when the range had to be widened a lot
+        result = this->bisection_find_mode(omega_lower, omega_upper, n_mode, max_steps, verbose);
+    if(result)
+        return result;
+
+    return this->converge_through_infty_behavior(omega_lower, omega_upper, n_mode, max_steps, delta_omega, verbose);
+}
+
 
 // uses the bisection method to calculate a FBS solution with fixed rho_c and fixed particle ratio Nb/Nf
 // optimized phi_c and omega in the process.
@@ -497,7 +701,7 @@ void FermionBosonStar::shooting_NbNf_ratio(double NbNf_ratio, double NbNf_accura
  * and calculates the star properties
  * M_T, N_B, N_F, R_B, R_F
  * */
-void FermionBosonStar::calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events) {
+void FermionBosonStar::calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events, Workspace* workspace) {
     const int step_number = results.size();
 
     /* find the index where the phi field converged (to accurately compute the bosonic radius component later)
@@ -508,11 +712,11 @@ void FermionBosonStar::calculate_star_parameters(const std::vector<integrator::s
     if (this->phi_0 > 0.) {
         if(this->R_B_0 >  0.) { // we artifically set phi to 0 at some point which makes our lifes much easier
             phi_converged = true;
-            while(results[index_phi_converged].first < this->R_B_0 && index_phi_converged < step_number-2)
+            while(results.r(index_phi_converged) < this->R_B_0 && index_phi_converged < step_number-2)
                 index_phi_converged++;
         }
         else { // we couldn't successfully set phi to 0 so find the closest thing
-            auto abs_phi_func = [&results] (int index) { return std::abs(results[index].second[2]); };
+            auto abs_phi_func = [&results] (int index) { return std::abs(results.y(index, 2)); };
             std::vector<int> abs_phi_minima({});
             int index_phi_global_min = 0;
             for (unsigned int i=1; i < results.size()-1; i++) {
@@ -534,9 +738,9 @@ void FermionBosonStar::calculate_star_parameters(const std::vector<integrator::s
      * M_T := r/2 * ( 1 - 1/(a^2) )
      * */
     double M_T = 0.;
-    auto M_func = [&results](int index) { return results[index].first / 2. * (1. - 1./pow(results[index].second[0], 2)); };
-    auto dM_func = [&results, &M_func](int i) { return  (M_func(i+1) - M_func(i))/(results[i+1].first - results[i].first)/ 2.
-                                                        + (M_func(i) - M_func(i-1))/(results[i].first - results[i-1].first)/2.; };
+    auto M_func = [&results](int index) { return results.r(index) / 2. * (1. - 1./pow(results.y(index, 0), 2)); };
+    auto dM_func = [&results, &M_func](int i) { return  (M_func(i+1) - M_func(i))/(results.r(i+1) - results.r(i))/ 2.
+                                                        + (M_func(i) - M_func(i-1))/(results.r(i) - results.r(i-1))/2.; };
 
     if(phi_converged) { // no divergence -> read M_T out at the end
         M_T = M_func(step_number-1);
@@ -557,23 +761,25 @@ void FermionBosonStar::calculate_star_parameters(const std::vector<integrator::s
 
     /*  N_B, N_F
      *  We need to integrate the particle number densities to obtain N_B, N_F */
-    std::vector<double> r(step_number), N_B_integrand(step_number), N_F_integrand(step_number);
-    vector v;
-    double rho, eps;
+    const std::vector<double>& r = results.r();
+    const std::vector<double>& a = results.column(0), &alpha = results.column(1), &phi = results.column(2), &P = results.column(4);
+    Workspace local_workspace;
+    Workspace& ws = workspace ? *workspace : local_workspace;
+    std::vector<double>& N_B_integrand = ws.array(0, step_number), &N_F_integrand = ws.array(1, step_number);
+
+    // the restmass density of all steps in one call, it is written into N_F_integrand
+    //  (epsilon is not needed, it is written into slot 2, which is only used for the integration below)
+    this->EOS->callEOS_batch(P.data(), N_F_integrand.data(), ws.array(2, step_number).data(), step_number);
+    const double P_min = std::max(P_ns_min, this->EOS->min_P());
 
     for(unsigned int i = 0; i < results.size(); i++) {
-        r[i] = results[i].first;
-        v = results[i].second;
-        N_B_integrand[i] = 8.*M_PI * v[0] * this->omega *  v[2] * v[2] * r[i] * r[i] / v[1];  // get bosonic mass (paricle number) for each r
-        if (v[4] < P_ns_min || v[4] < this->EOS->min_P())
-            rho = 0.;
-        else
-            this->EOS->callEOS(rho, eps, v[4]);
-        N_F_integrand[i] = 4.*M_PI * v[0] * rho * r[i] * r[i] ;   // get fermionic mass (paricle number) for each r
+        N_B_integrand[i] = 8.*M_PI * a[i] * this->omega *  phi[i] * phi[i] * r[i] * r[i] / alpha[i];  // get bosonic mass (paricle number) for each r
+        const double rho = P[i] < P_min ? 0. : N_F_integrand[i];
+        N_F_integrand[i] = 4.*M_PI * a[i] * rho * r[i] * r[i] ;   // get fermionic mass (paricle number) for each r
     }
 
     // Integrate
-    std::vector<double> N_F_integrated, N_B_integrated;
+    std::vector<double>& N_F_integrated = ws.array(2, step_number), &N_B_integrated = ws.array(3, step_number);
     integrator::cumtrapz(r, N_F_integrand, N_F_integrated);
     integrator::cumtrapz(r, N_B_integrand, N_B_integrated);
 
@@ -602,9 +808,7 @@ void FermionBosonStar::calculate_star_parameters(const std::vector<integrator::s
      * iterate the Pressure-array until we find the first point where the pressure is zero */
     double R_F = 0.;
     int index_R_F = 0;
-    auto P_func = [&results] (int index) {return results[index].second[4];};
-
-    while( P_func(index_R_F) > std::max(P_ns_min, EOS->min_P())  && index_R_F < step_number-1)
+    while( P[index_R_F] > std::max(P_ns_min, EOS->min_P())  && index_R_F < step_number-1)
         index_R_F++;
     R_F = r[index_R_F];
     N_F = N_F_integrated[index_R_F];
@@ -615,29 +819,34 @@ void FermionBosonStar::calculate_star_parameters(const std::vector<integrator::s
 
 /* Simple wrapper function if the results of the integration are not needed for the user */
 void FermionBosonStar::evaluate_model() {
-    std::vector<integrator::step> results;
-    this->evaluate_model(results);
+    Workspace workspace;
+    this->evaluate_model(workspace);
+}
+
+void FermionBosonStar::evaluate_model(Workspace& workspace) {
+    this->evaluate_model(workspace.trajectory(0), integrator::IntegrationOptions(), "", &workspace);
 }
 
 /* This function integrates over the ODE system while avoiding the phi divergence
  *  and then calculates the star properties
  *  Optionally, the output of the integration is saved in the file
  *  Only call if omega is the corresponding eigenfrequency of mu, lambda, rho_0, phi_0 */
-void FermionBosonStar::evaluate_model(std::vector<integrator::step>& results, integrator::IntegrationOptions intOpts, std::string filename) {
+void FermionBosonStar::evaluate_model(integrator::Trajectory& results, integrator::IntegrationOptions intOpts, std::string filename, Workspace* workspace) {
 
     const bool force_phi_to_zero = false;
     intOpts.save_intermediate = true;
     intOpts.verbose = 0;
 
-    std::vector<integrator::Event> events;
+    Workspace local_workspace;
+    std::vector<integrator::Event>& events = (workspace ? *workspace : local_workspace).events();
 
     integrator::Event P_min_reached = FermionBosonStar::P_min_reached; // the presence of this event will increase the accuracy around R_F
     if(this->rho_0 > 0.)
         events.push_back(P_min_reached);
 
-    this->integrate_and_avoid_phi_divergence(results, events, intOpts, force_phi_to_zero);
+    this->integrate_and_avoid_phi_divergence(results, events, intOpts, force_phi_to_zero, {}, -1., -1., workspace);
 
-    this->calculate_star_parameters(results, events);
+    this->calculate_star_parameters(results, events, workspace);
 
     if(!filename.empty()) {
         plotting::save_integration_data(results, {0,1,2,3,4}, {"a", "alpha", "phi", "Psi", "P"}, filename);
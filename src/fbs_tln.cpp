@@ -2,6 +2,85 @@
 
 using namespace FBS;
 
+FermionBosonStarBackground::FermionBosonStarBackground(const FermionBosonStarTLN& star, const integrator::Trajectory& results) : index_R_B_0(0) {
+    radii.reserve(results.size()+1); y_steps.reserve(results.size()+1); dy_steps.reserve(results.size()+1);
+    for(std::size_t i = 0; i < results.size(); i++) {
+        fixed_vector<5> y_i;
+        for(unsigned int k = 0; k < 5; k++)
+            y_i[k] = results.y(i, k);
+        // the integration continued from the first step beyond R_B_0 with phi = Psi = 0, this state isn't in the results, as they only keep the step before
+        if(star.phi_0 > 0. && star.R_B_0 > 0. && index_R_B_0 == 0 && i > 0 && results.r(i-1) > star.R_B_0) {
+            fixed_vector<5> y_R_B_0 = y_steps.back();
+            y_R_B_0[2] = 0.; y_R_B_0[3] = 0.;
+            index_R_B_0 = radii.size();
+            radii.push_back(radii.back()); y_steps.push_back(y_R_B_0); dy_steps.push_back(star.FermionBosonStar::dy_dr(radii.back(), y_R_B_0));
+        }
+        radii.push_back(results.r(i)); y_steps.push_back(y_i); dy_steps.push_back(star.FermionBosonStar::dy_dr(results.r(i), y_i));
+    }
+
+    // at the center, c[0] and c[2] go as 1/r and c[1] and c[5] as 1/r^2, so these are interpolated times r and r^2
+    auto scaled_coefficients = [&star](const double r, const fixed_vector<5>& y, const fixed_vector<5>& dy) {
+        fixed_vector<6> c = star.perturbation_coefficients(r, y, dy);
+        c[0] *= r; c[1] *= r*r; c[2] *= r; c[5] *= r*r;
+        return c;
+    };
+    // the cubic polynomials through the values at t = 0, 1/3, 2/3, 1 in Newton's form, converted to powers of t
+    coefficient_polynomials.resize(radii.size());
+    fixed_vector<6> c_0 = scaled_coefficients(radii[0], y_steps[0], dy_steps[0]);
+    for(std::size_t i = 0; i + 1 < radii.size(); i++) {
+        const fixed_vector<6> c_3 = scaled_coefficients(radii[i+1], y_steps[i+1], dy_steps[i+1]);
+        if(radii[i+1] > radii[i]) {     // not the step of zero length at R_B_0
+            fixed_vector<5> y, dy;
+            const double h = radii[i+1] - radii[i];
+            integrator::dense_output(radii[i], y_steps[i], dy_steps[i], radii[i+1], y_steps[i+1], dy_steps[i+1], radii[i] + h/3., y, dy);
+            const fixed_vector<6> c_1 = scaled_coefficients(radii[i] + h/3., y, dy);
+            integrator::dense_output(radii[i], y_steps[i], dy_steps[i], radii[i+1], y_steps[i+1], dy_steps[i+1], radii[i] + 2.*h/3., y, dy);
+            const fixed_vector<6> c_2 = scaled_coefficients(radii[i] + 2.*h/3., y, dy);
+            std::array<fixed_vector<6>, 4>& p = coefficient_polynomials[i];
+            for(unsigned int k = 0; k < 6; k++) {
+                const double d_1 = c_1[k] - c_0[k], d_2 = c_2[k] - 2.*c_1[k] + c_0[k], d_3 = c_3[k] - 3.*c_2[k] + 3.*c_1[k] - c_0[k];
+                p[0][k] = c_0[k];
+                p[1][k] = 3.*d_1 - 1.5*d_2 + d_3;
+                p[2][k] = 4.5*d_2 - 4.5*d_3;
+                p[3][k] = 4.5*d_3;
+            }
+        }
+        c_0 = c_3;
+    }
+}
+
+std::size_t FermionBosonStarBackground::find_step(const double r, const bool after_R_B_0, std::size_t& hint) const {
+    const std::size_t begin = after_R_B_0 ? index_R_B_0 : 0, end = after_R_B_0 || index_R_B_0 == 0 ? radii.size() : index_R_B_0;
+    // the step i with radii[i] <= r < radii[i+1] inside [begin, end), r outside of the range is extrapolated from the first or last step
+    std::size_t i = hint;
+    if(i < begin || i + 1 >= end || r < radii[i] || r >= radii[i+1]) {
+        if(i + 2 < end && i >= begin && r >= radii[i+1] && r < radii[i+2])   // the next step, as the integration proceeds
+            i++;
+        else {
+            i = std::upper_bound(radii.begin() + begin, radii.begin() + end, r) - radii.begin();
+            i = std::min(std::max(i, begin + 1), end - 1) - 1;
+        }
+    }
+    hint = i;
+    return i;
+}
+
+void FermionBosonStarBackground::interpolate(const double r, const bool after_R_B_0, fixed_vector<5>& y, fixed_vector<5>& dy, std::size_t& hint) const {
+    const std::size_t i = this->find_step(r, after_R_B_0, hint);
+    integrator::dense_output(radii[i], y_steps[i], dy_steps[i], radii[i+1], y_steps[i+1], dy_steps[i+1], r, y, dy);
+}
+
+fixed_vector<6> FermionBosonStarBackground::coefficients(const double r, const bool after_R_B_0, std::size_t& hint) const {
+    const std::size_t i = this->find_step(r, after_R_B_0, hint);
+    const std::array<fixed_vector<6>, 4>& p = coefficient_polynomials[i];
+    const double t = (r - radii[i]) / (radii[i+1] - radii[i]), inv_r = 1./r;
+    fixed_vector<6> c;
+    for(unsigned int k = 0; k < 6; k++)
+        c[k] = p[0][k] + t*(p[1][k] + t*(p[2][k] + t*p[3][k]));
+    c[0] *= inv_r; c[1] *= inv_r*inv_r; c[2] *= inv_r; c[5] *= inv_r*inv_r;
+    return c;
+}
+
 /* This event triggers when dphi_1 is diverging i.e. dphi_1 > 1e6 */
 const integrator::Event FermionBosonStarTLN::dphi_1_diverging = integrator::Event([](const double r, const double dr, const vector& y, const vector& dy, const void*params) { return (std::abs(y[8]) > 1e6); }, true, "dphi_1_diverging");
 
@@ -27,9 +106,16 @@ vector FermionBosonStarTLN::get_initial_conditions(double r_init) const {
  *  This function is called by the integrator during the integration
  * */
 vector FermionBosonStarTLN::dy_dr(const double r, const vector& vars) const {
+    return this->dy_dr(r, fixed_vector<9>(vars)).to_vector();
+}
+
+/* The perturbation equations are linear in H, dH, phi_1, dphi_1:
+ *  ddH_dr2     = c[0] dH + c[1] H + c[2] phi_1
+ *  ddphi_1_dr2 = c[3] dphi_1 + c[4] H + c[5] phi_1
+ * where the coefficients c only depend on the background a, alpha, phi, Psi, P and their derivatives dy_dr */
+fixed_vector<6> FermionBosonStarTLN::perturbation_coefficients(const double r, const fixed_vector<5>& vars, const fixed_vector<5>& dy_dr) const {
     const double a = vars[0], alpha = vars[1], phi = vars[2], Psi = vars[3];
     double P = vars[4];
-    const double H = vars[5],  dH_dr = vars[6],  phi_1 = vars[7], dphi_1_dr = vars[8];
 
     EquationOfState& myEOS = *(this->EOS);
 
@@ -37,12 +123,12 @@ vector FermionBosonStarTLN::dy_dr(const double r, const vector& vars) const {
     if(P <= 0. || P < myEOS.min_P() || P < P_ns_min)  {
         P = 0.; e = 0., de_dP = 0.;
     } else {
-        e = myEOS.get_e_from_P(P);
-        dP_de = e > myEOS.min_e() ? myEOS.dP_de(e) : 0.;
+        const EoSQuantities eos = myEOS.query(P);
+        e = eos.e;
+        dP_de = e > myEOS.min_e() ? eos.dP_de : 0.;
         de_dP = dP_de > 0. ? 1./dP_de : 0.;
     }
 
-    vector dy_dr = FermionBosonStar::dy_dr(r, vars); // use equations as given in parent class
     const double da_dr = dy_dr[0],  dalpha_dr = dy_dr[1], dphi_dr = dy_dr[2], dPsi_dr = dy_dr[3], dP_dr = dy_dr[4];
 
     // The equations for the bosonic field potential
@@ -57,35 +143,197 @@ vector FermionBosonStarTLN::dy_dr(const double r, const vector& vars) const {
                                 + ( 4.*M_PI*r* ( 2.*P*a*da_dr - 2.*V*a*da_dr - 2.*phi*a*a*Psi*dV_deps + a*a*dP_dr + 2.*Psi*dPsi_dr)
                                     + 4.*M_PI*a*a*(P - V) + 4.*M_PI*Psi*Psi + a*da_dr/r + (1. - a*a)/2./r/r )*alpha;
 
-    const double ddH_dr2 = (da_dr/a - dalpha_dr/alpha - 2./r) * dH_dr
-                            + (8.*omega*omega*M_PI*phi*phi*a*a/alpha/alpha*(-1.+ de_dP) + 8.*M_PI *dphi_dr*dphi_dr*(3. + de_dP)
+    return fixed_vector<6>({ da_dr/a - dalpha_dr/alpha - 2./r,
+                            8.*omega*omega*M_PI*phi*phi*a*a/alpha/alpha*(-1.+ de_dP) + 8.*M_PI *dphi_dr*dphi_dr*(3. + de_dP)
                                     - 2.*ddalpha_dr2/alpha + 2.*dalpha_dr*da_dr/alpha/a + 4.*dalpha_dr*dalpha_dr/alpha/alpha - da_dr/r/a*(3.+ de_dP) - dalpha_dr/r/alpha*(7. + de_dP)
-                                    + 6*a*a/r/r) * H
-                            + (16.*omega*omega*M_PI*phi*a*a/r/alpha/alpha*(1. - de_dP) + 16.*M_PI*phi*a*a*dV_deps/r*(1. +de_dP) - 16.*M_PI* dPsi_dr/r*(3. + de_dP)
-                                    + 16.*M_PI*dphi_dr*da_dr/r/a *(3. + de_dP) + 16.*M_PI*dalpha_dr*dphi_dr/r/alpha*(1. - de_dP) - 32.*M_PI*dphi_dr/r/r*(3. + de_dP)) * phi_1;
-
-    const double ddphi_1_dr2 = (da_dr/a - dalpha_dr/alpha)* dphi_1_dr
-                                + (omega*omega*r*phi*a*a/alpha/alpha - r*dPsi_dr + (r*da_dr/a + r*dalpha_dr/alpha -2.)*dphi_dr )* H
-                                + (-omega*omega*a*a/alpha/alpha + 32.*M_PI*Psi*Psi + 2.*phi*phi*a*a*ddV_deps2 + a*a*dV_deps - da_dr/r/a + dalpha_dr/r/alpha + 6.*a*a/r/r)*phi_1;
-
-    /*std::cout << "r = " << r
-                << ", ddalpha_dr2 = " << ddalpha_dr2
-                << ", drho/dP = " << de_dP
-                << ", ddH_dr2 = " << ddH_dr2
-                << ", dH_dr = " << dH_dr
-                << ", H = " << H
-                << ". ddphi_1_dr2 = " << ddphi_1_dr2
-                << ", dphi_1_dr = " << dphi_1_dr
-                << ", phi_1 = " << phi_1
-                << std::endl;*/
-    return vector({dy_dr[0], dy_dr[1], dy_dr[2], dy_dr[3], dy_dr[4], dH_dr, ddH_dr2, dphi_1_dr, ddphi_1_dr2});
+                                    + 6*a*a/r/r,
+                            16.*omega*omega*M_PI*phi*a*a/r/alpha/alpha*(1. - de_dP) + 16.*M_PI*phi*a*a*dV_deps/r*(1. +de_dP) - 16.*M_PI* dPsi_dr/r*(3. + de_dP)
+                                    + 16.*M_PI*dphi_dr*da_dr/r/a *(3. + de_dP) + 16.*M_PI*dalpha_dr*dphi_dr/r/alpha*(1. - de_dP) - 32.*M_PI*dphi_dr/r/r*(3. + de_dP),
+                            da_dr/a - dalpha_dr/alpha,
+                            omega*omega*r*phi*a*a/alpha/alpha - r*dPsi_dr + (r*da_dr/a + r*dalpha_dr/alpha -2.)*dphi_dr,
+                            -omega*omega*a*a/alpha/alpha + 32.*M_PI*Psi*Psi + 2.*phi*phi*a*a*ddV_deps2 + a*a*dV_deps - da_dr/r/a + dalpha_dr/r/alpha + 6.*a*a/r/r });
+}
+
+fixed_vector<9> FermionBosonStarTLN::dy_dr(const double r, const fixed_vector<9>& vars) const {
+    const double H = vars[5],  dH_dr = vars[6],  phi_1 = vars[7], dphi_1_dr = vars[8];
+
+    const fixed_vector<5> dy_dr = FermionBosonStar::dy_dr(r, vars.sub_range<0, 5>()); // use equations as given in parent class
+    const fixed_vector<6> c = this->perturbation_coefficients(r, vars.sub_range<0, 5>(), dy_dr);
+
+    const double ddH_dr2 = c[0]*dH_dr + c[1]*H + c[2]*phi_1;
+    const double ddphi_1_dr2 = c[3]*dphi_1_dr + c[4]*H + c[5]*phi_1;
+
+    return fixed_vector<9>({dy_dr[0], dy_dr[1], dy_dr[2], dy_dr[3], dy_dr[4], dH_dr, ddH_dr2, dphi_1_dr, ddphi_1_dr2});
+}
+
+int FermionBosonStarTLN::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    if(this->background)
+        return this->integrate_perturbations(1, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    return this->integrate_fixed<FermionBosonStarTLN, 9>(result, events, initial_conditions, intOpts, r_init, r_end, observer);
+}
+
+namespace {
+
+/* PerturbationIntegration
+ * The integration of K solutions of the perturbations forced by the background, see FermionBosonStarTLN::integrate_perturbations
+ * The integrator only sees H, dH, phi_1, dphi_1 of the solutions. The events of the caller are replaced by the conditions below,
+ *  which pass the full state a, alpha, phi, Psi, P, (H, dH, phi_1, dphi_1) x K with the background at r on to the events */
+template <std::size_t K>
+struct PerturbationIntegration {
+    static const std::size_t max_events = 8;
+
+    const FermionBosonStarBackground& background;
+    const bool after_R_B_0;
+    const std::vector<integrator::Event>& events;   // of the caller
+    const void* params;                             // the star, for the events of the caller
+    mutable std::size_t hint;
+    mutable double r_background;                    // the background is only interpolated again for a new r
+    mutable fixed_vector<5> y_background, dy_background;
+    mutable vector y, dy;
+
+    PerturbationIntegration(const FermionBosonStarBackground& background, const bool after_R_B_0, const std::vector<integrator::Event>& events, const void* params)
+        : background(background), after_R_B_0(after_R_B_0), events(events), params(params), hint(0), r_background(-1.), y(5+4*K), dy(5+4*K) {}
+
+    /* fills y, dy with the full state at r for the perturbations h and their derivatives dh */
+    void expand(const double r, const vector& h, const vector& dh) const {
+        if(r != r_background) {
+            background.interpolate(r, after_R_B_0, y_background, dy_background, hint);
+            r_background = r;
+        }
+        for(unsigned int k = 0; k < 5; k++) {
+            y[k] = y_background[k]; dy[k] = dy_background[k];
+        }
+        for(unsigned int k = 0; k < 4*K; k++) {
+            y[5+k] = h[k]; dy[5+k] = dh[k];
+        }
+    }
+
+    /* the condition of the k-th event of the caller */
+    template <std::size_t k>
+    static bool condition(const double r, const double dr, const vector& h, const vector& dh, const void* params) {
+        const PerturbationIntegration& integration = *static_cast<const PerturbationIntegration*>(params);
+        integration.expand(r, h, dh);
+        return integration.events[k].condition(r, dr, integration.y, integration.dy, integration.params);
+    }
+
+    static integrator::event_condition event_condition(const std::size_t k) {
+        static const integrator::event_condition conditions[max_events] = {condition<0>, condition<1>, condition<2>, condition<3>,
+                                                                            condition<4>, condition<5>, condition<6>, condition<7>};
+        return conditions[k];
+    }
+};
+
+/* passes the full state on to the observer of the caller */
+template <std::size_t K>
+class PerturbationObserver : public integrator::Observer {
+protected:
+    const PerturbationIntegration<K>& integration;
+    integrator::Observer* observer;
+public:
+    PerturbationObserver(const PerturbationIntegration<K>& integration, integrator::Observer* observer) : integration(integration), observer(observer) {}
+
+    void observe(const double r, const vector& h, const vector& dh) {
+        integration.expand(r, h, dh);
+        observer->observe(r, integration.y, integration.dy);
+    }
+};
+
+template <std::size_t K>
+int integrate_perturbations(const FermionBosonStarBackground& background, std::size_t& hint, const bool after_R_B_0, const void* params,
+                                integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector& initial_conditions,
+                                const integrator::IntegrationOptions& intOpts, const double r_init, const double r_end, integrator::Observer* observer) {
+    if(initial_conditions.size() != 5 + 4*K)
+        throw std::runtime_error("FermionBosonStarTLN: the initial conditions don't match the number of perturbations");
+    if(events.size() > PerturbationIntegration<K>::max_events)
+        throw std::runtime_error("FermionBosonStarTLN: too many events for the integration of the perturbations");
+
+    fixed_vector<4*K> h_0;
+    for(unsigned int k = 0; k < 4*K; k++)
+        h_0[k] = initial_conditions[5+k];
+
+    const PerturbationIntegration<K> integration(background, after_R_B_0, events, params);
+    std::vector<integrator::Event> perturbation_events(events);
+    for(std::size_t k = 0; k < events.size(); k++)
+        perturbation_events[k].condition = PerturbationIntegration<K>::event_condition(k);
+    PerturbationObserver<K> perturbation_observer(integration, observer);
+
+    // H, dH, phi_1, dphi_1 of every solution
+    auto dh_dr = [&background, &hint, after_R_B_0](const double r, const fixed_vector<4*K>& h, const void*) {
+        const fixed_vector<6> c = background.coefficients(r, after_R_B_0, hint);
+        fixed_vector<4*K> dh;
+        for(unsigned int k = 0; k < 4*K; k += 4) {
+            dh[k] = h[k+1];
+            dh[k+1] = c[0]*h[k+1] + c[1]*h[k] + c[2]*h[k+2];
+            dh[k+2] = h[k+3];
+            dh[k+3] = c[3]*h[k+3] + c[4]*h[k] + c[5]*h[k+2];
+        }
+        return dh;
+    };
+    integrator::Trajectory& perturbations = Workspace::thread_local_instance().trajectory(2);
+    const int res = integrator::RKF45(dh_dr, r_init, h_0, r_end, (const void*)&integration, perturbations, perturbation_events, intOpts,
+                                        observer ? &perturbation_observer : nullptr);
+
+    // the results and the new steps of the events get the full state
+    fixed_vector<5+4*K> y;
+    fixed_vector<5> y_background, dy_background;
+    result.clear();
+    result.reserve(perturbations.size());
+    for(std::size_t i = 0; i < perturbations.size(); i++) {
+        background.interpolate(perturbations.r(i), after_R_B_0, y_background, dy_background, integration.hint);
+        for(unsigned int k = 0; k < 5; k++)
+            y[k] = y_background[k];
+        for(unsigned int k = 0; k < 4*K; k++)
+            y[5+k] = perturbations.y(i, k);
+        result.push_back(perturbations.r(i), y);
+    }
+    for(std::size_t k = 0; k < events.size(); k++) {
+        const std::size_t old_steps = intOpts.clean_events ? 0 : events[k].steps.size();
+        events[k].active = perturbation_events[k].active;
+        events[k].steps = std::move(perturbation_events[k].steps);
+        for(std::size_t j = old_steps; j < events[k].steps.size(); j++) {
+            integrator::step& step = events[k].steps[j];
+            integration.expand(step.first, step.second, step.second);
+            step.second = integration.y;
+        }
+    }
+    return res;
+}
+
+}
+
+int FermionBosonStarTLN::integrate_perturbations(const unsigned int n_solutions, integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector& initial_conditions,
+                                                    const integrator::IntegrationOptions& intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    r_init = (r_init < 0. ? this->r_init : r_init);
+    r_end = std::min(r_end < 0. ? this->r_end : r_end, this->background->r_end());  // the background isn't known further out
+    const bool after_R_B_0 = this->phi_0 > 0. && this->R_B_0 > 0. && r_init > this->R_B_0;
+    if(n_solutions == 1)
+        return ::integrate_perturbations<1>(*this->background, this->background_hint, after_R_B_0, (const void*)this,
+                                                result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    return ::integrate_perturbations<2>(*this->background, this->background_hint, after_R_B_0, (const void*)this,
+                                            result, events, initial_conditions, intOpts, r_init, r_end, observer);
+}
+
+int FermionBosonStarTLN::set_background(const integrator::Trajectory& results) {
+    this->background.reset();
+    if(results.size() < 2 || results.dim() < 5)
+        return -1;
+    auto background = std::make_shared<const FermionBosonStarBackground>(*this, results);
+    // without R_B_0, phi diverges at the end of the background
+    if(this->phi_0 > 0. && (this->R_B_0 <= 0. || background->size() == results.size()))
+        return -1;
+    this->background = background;
+    return 0;
+}
+
+void FermionBosonStarTLN::clear_background() {
+    this->background.reset();
 }
 
 /* This function takes the result of an integration of the FBS+TLN system
  * and calculates the star properties
  * lambda_tidal, k2, y_max, R_ext
  * */
-void FermionBosonStarTLN::calculate_star_parameters(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events) {
+void FermionBosonStarTLN::calculate_star_parameters(const integrator::Trajectory& results, const std::vector<integrator::Event>& events) {
 
     const int step_number = results.size();
     // calculate parameters for unperturbed star
@@ -100,37 +348,37 @@ void FermionBosonStarTLN::calculate_star_parameters(const std::vector<integrator
 
     /* The quantity to compute is y = r H' / H
      * at the point where both components have converged */
-    auto M_func = [&results](int index) { return results[index].first / 2. * (1. - 1./pow(results[index].second[0], 2)); };
-    auto y_func = [&results](int index) { return results[index].first * results[index].second[6]/ results[index].second[5]; };
-    auto dy_func = [&results, &y_func] (int i) { return (y_func(i+1) - y_func(i))/(results[i+1].first - results[i].first)/2. + (y_func(i) - y_func(i-1))/(results[i].first - results[i-1].first)/2.;  };
+    auto M_func = [&results](int index) { return results.r(index) / 2. * (1. - 1./pow(results.y(index, 0), 2)); };
+    auto y_func = [&results](int index) { return results.r(index) * results.y(index, 6)/ results.y(index, 5); };
+    auto dy_func = [&results, &y_func] (int i) { return (y_func(i+1) - y_func(i))/(results.r(i+1) - results.r(i))/2. + (y_func(i) - y_func(i-1))/(results.r(i) - results.r(i-1))/2.;  };
     double y = 0., R_ext = 0., M_ext = 0.;
 
 
     if(phi_converged) {
         int index_ext = 0;
         R_ext = std::max(this->R_B_0, this->R_F);
-        while(results[index_ext].first < R_ext && index_ext < step_number-2)
+        while(results.r(index_ext) < R_ext && index_ext < step_number-2)
             index_ext++;
 
         y = y_func(index_ext);
         M_ext = M_func(index_ext);
-        R_ext = results[index_ext].first;
+        R_ext = results.r(index_ext);
     }
     else {
         if(this->R_F > 100.*this->R_B) { // in this case, the fermionic part dominates the bosonic part, so we can read out the TLN where the fermionic part vanishes
             int index_R_F = 0;
-            while ( results[index_R_F].first < this->R_F && index_R_F < step_number-1)
+            while ( results.r(index_R_F) < this->R_F && index_R_F < step_number-1)
                 index_R_F++;
             // approximate y, M_ext at R_F
-            y = y_func(index_R_F-1) +  (y_func(index_R_F) - y_func(index_R_F-1)) / (results[index_R_F].first - results[index_R_F-1].first) * (this->R_F - results[index_R_F-1].first);
-            M_ext = M_func(index_R_F-1) +  (M_func(index_R_F) - M_func(index_R_F-1)) / (results[index_R_F].first - results[index_R_F-1].first) * (this->R_F - results[index_R_F-1].first);
+            y = y_func(index_R_F-1) +  (y_func(index_R_F) - y_func(index_R_F-1)) / (results.r(index_R_F) - results.r(index_R_F-1)) * (this->R_F - results.r(index_R_F-1));
+            M_ext = M_func(index_R_F-1) +  (M_func(index_R_F) - M_func(index_R_F-1)) / (results.r(index_R_F) - results.r(index_R_F-1)) * (this->R_F - results.r(index_R_F-1));
             R_ext = R_F;
             //std::cout << "R_F > R_B:  at R_F=" << R_F << " y = " << y << std::endl;
         }
         else { // implement procedure from Sennet 2017 (https://arxiv.org/pdf/1704.08651.pdf)
             // to find the starting point see where y actually has a minimum
             int index_bs_radius = 1;
-            while(results[index_bs_radius].first < this->R_B/1e3  && index_bs_radius < step_number-2)
+            while(results.r(index_bs_radius) < this->R_B/1e3  && index_bs_radius < step_number-2)
                 index_bs_radius++;
             int index_y_min = index_bs_radius;
             while(y_func(index_y_min) < y_func(index_y_min-1) && index_y_min < step_number-2)
@@ -139,7 +387,7 @@ void FermionBosonStarTLN::calculate_star_parameters(const std::vector<integrator
             // now look for the local maxima&saddle points of y going from left to right (low r to higher r)
             std::vector<int> indices_maxima;
             for( unsigned int i = index_y_min + 1; i < results.size()-2; i++) {
-                //std::cout << "i=" << i << ", r= " << results[i].first << ", y = " << y_func(i) << ", dy = " << dy_func(i) << std::endl;
+                //std::cout << "i=" << i << ", r= " << results.r(i) << ", y = " << y_func(i) << ", dy = " << dy_func(i) << std::endl;
                 if(   (y_func(i) > y_func(i -1) && y_func(i) > y_func(i+1) )
                         ||  ( y_func(i) > y_func(i-1) && dy_func(i) < dy_func(i-1) && dy_func(i) < dy_func(i+1)) ) {
                     indices_maxima.push_back(i);
@@ -153,7 +401,7 @@ void FermionBosonStarTLN::calculate_star_parameters(const std::vector<integrator
             else
                 index_y = indices_maxima.at(indices_maxima.size()-1);
             y = y_func(index_y);
-            R_ext = results[index_y].first;
+            R_ext = results.r(index_y);
             M_ext = M_func(index_y); // extract M_ext at the same radius
         }
     }
@@ -177,7 +425,7 @@ void FermionBosonStarTLN::calculate_star_parameters(const std::vector<integrator
 }
 
 void FermionBosonStarTLN::evaluate_model() {
-    std::vector<integrator::step> results;
+    integrator::Trajectory results;
     this->evaluate_model(results);
 }
 
@@ -185,7 +433,7 @@ void FermionBosonStarTLN::evaluate_model() {
  *  and then calculates the star properties
  *  Optionally, the output of the integration is saved in the file
  *  Additionally, y is calculated at every point for debugging purposes */
-void FermionBosonStarTLN::evaluate_model(std::vector<integrator::step>& results, std::string filename) {
+void FermionBosonStarTLN::evaluate_model(integrator::Trajectory& results, std::string filename) {
 
     integrator::IntegrationOptions intOpts;
     intOpts.save_intermediate = true;
@@ -200,13 +448,13 @@ void FermionBosonStarTLN::evaluate_model(std::vector<integrator::step>& results,
 
     this->calculate_star_parameters(results, events);
 
-    auto y_func = [&results](int index) { return results[index].first * results[index].second[6]/ results[index].second[5]; };
+    auto y_func = [&results](int index) { return results.r(index) * results.y(index, 6)/ results.y(index, 5); };
     if(!filename.empty()) {
         // add y to results list for easy plotting
-        for(unsigned int i = 0; i < results.size(); i++) {
-            auto s = results[i].second;
-            results[i].second = vector({s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8], y_func(i)});
-        }
+        std::vector<double> y(results.size());
+        for(unsigned int i = 0; i < results.size(); i++)
+            y[i] = y_func(i);
+        results.add_column(y);
         plotting::save_integration_data(results, {0,1,2,3,4,5,6,7,8,9}, {"a", "alpha", "phi", "Psi", "P", "H", "dH", "phi_1", "dphi_1", "y"}, filename);
 
         std::vector<integrator::Event> events;
@@ -231,7 +479,7 @@ int FermionBosonStarTLN::bisection_phi_1_find_mode(double& phi_1_0_l, double& ph
     integrator::IntegrationOptions intOpts;
     intOpts.verbose = verbose - 1;
     std::vector<integrator::Event> events = {phi_1_negative, phi_1_positive, dphi_1_diverging};
-    std::vector<integrator::step> results_0, results_1, results_mid;
+    integrator::Trajectory results_0, results_1, results_mid;
 
 
     // set the lower phi_1 and integrate the ODEs:
@@ -279,6 +527,34 @@ int FermionBosonStarTLN::bisection_phi_1_find_mode(double& phi_1_0_l, double& ph
     return 0;
 }
 
+int FermionBosonStarTLN::bisection_phi_1_sign_range(double& phi_1_0_l, double& phi_1_0_r, int verbose) {
+
+    const int index_phi_1 = 7;
+    const bool force_phi_to_0 = true;
+    integrator::IntegrationOptions intOpts;
+    intOpts.verbose = verbose - 1;
+    std::vector<integrator::Event> events = { dphi_1_diverging};
+    integrator::Trajectory results;
+
+    // whether phi_1 is positive where it diverges
+    auto n_inft = [&] (double phi_1_0) {
+        this->phi_1_0 = phi_1_0;
+        FermionBosonStar::integrate_and_avoid_phi_divergence(results, events, intOpts, force_phi_to_0);
+        return results.y(results.size()-1, index_phi_1) > 0.;
+    };
+
+    const bool n_inft_1 = n_inft(phi_1_0_r);
+    if(n_inft(phi_1_0_l) != n_inft_1)
+        return 0;
+    if(phi_1_0_l > 0. && n_inft(-phi_1_0_r) != n_inft_1) {
+        phi_1_0_l = -phi_1_0_r;
+        if (verbose > 0)
+            std::cout << "extended the range to phi_1_0_l =" << phi_1_0_l << std::endl;
+        return 0;
+    }
+    return -1;
+}
+
 int FermionBosonStarTLN::bisection_phi_1_converge_through_infty_behavior(double& phi_1_0_l, double& phi_1_0_r, int max_steps, double delta_phi_1, int verbose) {
 
     double phi_1_0_mid;
@@ -291,16 +567,16 @@ int FermionBosonStarTLN::bisection_phi_1_converge_through_infty_behavior(double&
     integrator::IntegrationOptions intOpts;
     intOpts.verbose = verbose - 1;
     std::vector<integrator::Event> events = { dphi_1_diverging};
-    std::vector<integrator::step> results_0, results_1, results_mid;
+    integrator::Trajectory results_0, results_1, results_mid;
     // find right behavior at infty ( Phi(r->infty) = 0 )
 
     this->phi_1_0 = phi_1_0_l;
     FermionBosonStar::integrate_and_avoid_phi_divergence(results_0, events, intOpts, force_phi_to_0);
-    n_inft_0 = results_0[results_0.size()-1].second[index_phi_1] > 0.;    // save if sign(Phi_1(inf)) is positive or negative
+    n_inft_0 = results_0.y(results_0.size()-1, index_phi_1) > 0.;    // save if sign(Phi_1(inf)) is positive or negative
 
     this->phi_1_0 = phi_1_0_r;
     FermionBosonStar::integrate_and_avoid_phi_divergence(results_1, events, intOpts, force_phi_to_0);
-    n_inft_1 = results_1[results_1.size()-1].second[index_phi_1] > 0.;
+    n_inft_1 = results_1.y(results_1.size()-1, index_phi_1) > 0.;
 
     if (verbose > 0)
         std::cout << "start with phi_1_0_l =" << phi_1_0_l << " with n_inft=" << n_inft_0 << " and phi_1_0_r =" << phi_1_0_r << " with n_inft=" << n_inft_1 << std::endl;
@@ -308,11 +584,13 @@ int FermionBosonStarTLN::bisection_phi_1_converge_through_infty_behavior(double&
     steps =0;
     /* iterate until accuracy in phi_1 was reached or max number of steps exceeded */
 
-    while( (phi_1_0_r - phi_1_0_l)/phi_1_0_l > delta_phi_1 && steps < max_steps) {
+    // the accuracy is relative to phi_1_0_l, or to the larger end if the range contains 0
+    auto range_width = [&] () { return (phi_1_0_r - phi_1_0_l)/(phi_1_0_l > 0. ? phi_1_0_l : std::max(-phi_1_0_l, phi_1_0_r)); };
+    while( range_width() > delta_phi_1 && steps < max_steps) {
         phi_1_0_mid = (phi_1_0_l + phi_1_0_r)/2.;
         this->phi_1_0 = phi_1_0_mid;
         FermionBosonStar::integrate_and_avoid_phi_divergence(results_mid, events, intOpts, force_phi_to_0);
-        n_inft_mid = results_mid[results_mid.size()-1].second[index_phi_1] > 0.;  // save if sign(Phi_1(inf)) is positive or negative
+        n_inft_mid = results_mid.y(results_mid.size()-1, index_phi_1) > 0.;  // save if sign(Phi_1(inf)) is positive or negative
         if (verbose > 1)
             std::cout << steps << ": phi_1_0_mid = " << phi_1_0_mid << " with n_inft= " << n_inft_mid << std::endl;
 
@@ -329,7 +607,7 @@ int FermionBosonStarTLN::bisection_phi_1_converge_through_infty_behavior(double&
         steps++;
     }
 
-    double last_r = results_mid[results_mid.size()-1].first;
+    double last_r = results_mid.r(results_mid.size()-1);
     if (verbose > 0)
         std::cout << "after " << steps << " steps found phi_1_0_l =" << phi_1_0_l << " with n_inft=" << n_inft_0 << " and phi_1_0_r=" << phi_1_0_r << " with n_inft=" << n_inft_1
                     << "\n  last_r = " << last_r << " vs R_F_0 = " << this->R_F_0 << "and R_B = " << this->R_B << std::endl;
@@ -340,7 +618,8 @@ int FermionBosonStarTLN::bisection_phi_1_converge_through_infty_behavior(double&
 /* This function finds the corresponding phi_1_0 inside the range (phi_1_0_l, phi_1_0_r)
  *  such that phi_1 adheres to the boundary conditions phi_1->0 at infty
  *  via a bisection algorithm, similarly to omega
- * This algorithm does not adjust the range
+ * This algorithm does not adjust the range, except for the ground state, where the range is extended to negative phi_1_0
+ *  if the sign of phi_1 at infinity is the same at both ends
  * The result depends on H_0, do not change afterwards */
 int FermionBosonStarTLN::bisection_phi_1(double phi_1_0_l, double phi_1_0_r, int n_mode, int max_steps, double delta_phi_1, int verbose) {
 
@@ -353,7 +632,12 @@ int FermionBosonStarTLN::bisection_phi_1(double phi_1_0_l, double phi_1_0_r, int
         return 0;
     }
 
+    const double phi_1_0_l_init = phi_1_0_l, phi_1_0_r_init = phi_1_0_r;
     int result = this->bisection_phi_1_find_mode(phi_1_0_l, phi_1_0_r, n_mode, max_steps, verbose);
+    if(result && n_mode == 0) {  // phi_1_0 might be outside of the range, e.g. negative
+        phi_1_0_l = phi_1_0_l_init; phi_1_0_r = phi_1_0_r_init;
+        result = this->bisection_phi_1_sign_range(phi_1_0_l, phi_1_0_r, verbose);
+    }
     if(result)
         return result;
     result = this->bisection_phi_1_converge_through_infty_behavior(phi_1_0_l, phi_1_0_r, max_steps, delta_phi_1, verbose);
@@ -364,6 +648,84 @@ int FermionBosonStarTLN::bisection_phi_1(double phi_1_0_l, double phi_1_0_r, int
     return 0;
 }
 
+/* This function finds phi_1_0 for the given H_0, such that phi_1 -> 0 at infty, from a single integration
+ * The perturbation equations are linear, so every solution is H_0 u_H + phi_1_0 u_phi, with the solutions u_H for H_0=1, phi_1_0=0
+ *  and u_phi for H_0=0, phi_1_0=1, which are integrated together with the background (see FermionBosonStarTLNBasis)
+ * At the end of the integration, where dphi_1 of one of them diverges, phi_1 of both is dominated by the growing part,
+ *  so the combination with phi_1 = 0 there stays regular. This is the limit of the bisection in bisection_phi_1 */
+int FermionBosonStarTLN::superposition_phi_1(int verbose) {
+
+    // if phi_0 = 0 then there is no field perturbation
+    if (this->phi_0 == 0.) {
+        this->phi_1_0 = 0.;
+        return 0;
+    }
+
+    const int index_phi_1_H = 7, index_phi_1_phi = 11;
+    const bool force_phi_to_0 = true;
+
+    // variables regarding the integration
+    integrator::IntegrationOptions intOpts;
+    intOpts.verbose = verbose - 1;
+    intOpts.save_intermediate = false;
+    std::vector<integrator::Event> events = {FermionBosonStarTLNBasis::dphi_1_diverging};
+    integrator::Trajectory results;
+
+    FermionBosonStarTLNBasis basis(*this);
+    basis.integrate_and_avoid_phi_divergence(results, events, intOpts, force_phi_to_0);
+
+    const std::size_t last = results.size()-1;
+    const double phi_1_H = results.y(last, index_phi_1_H), phi_1_phi = results.y(last, index_phi_1_phi);
+    const double phi_1_0 = -this->H_0 * phi_1_H / phi_1_phi;
+    if (verbose > 0)
+        std::cout << "superposition at r = " << results.r(last) << " with phi_1 = " << phi_1_H << " (H_0=1) and " << phi_1_phi << " (phi_1_0=1)"
+                    << ": phi_1_0 = " << phi_1_0 << std::endl;
+    if (!std::isfinite(phi_1_0))   // phi_1 of u_phi vanished at the end, e.g. the integration stopped early
+        return -1;
+
+    this->phi_1_0 = phi_1_0;
+    return 0;
+}
+
+
+/* This event triggers when dphi_1 of either solution is diverging i.e. dphi_1 > 1e6 */
+const integrator::Event FermionBosonStarTLNBasis::dphi_1_diverging = integrator::Event([](const double r, const double dr, const vector& y, const vector& dy, const void*params)
+                                                                                                { return (std::abs(y[8]) > 1e6 || std::abs(y[12]) > 1e6); }, true, "dphi_1_diverging");
+
+/* The initial conditions as in FermionBosonStarTLN, for H_0 = 1, phi_1_0 = 0 in the first and H_0 = 0, phi_1_0 = 1 in the second solution */
+vector FermionBosonStarTLNBasis::get_initial_conditions(double r_init) const {
+    r_init = (r_init < 0. ? this->r_init : r_init);
+    return vector( {1.0, 1.0, this->phi_0, 0., this->rho_0 > this->EOS->min_rho() ? this->EOS->get_P_from_rho(this->rho_0, 0.) : 0.,
+                                                             r_init*r_init, 2.*r_init, 0., 0.,
+                                                             0., 0., pow(r_init,3), 3.*pow(r_init,2)});
+}
+
+vector FermionBosonStarTLNBasis::dy_dr(const double r, const vector& vars) const {
+    return this->dy_dr(r, fixed_vector<13>(vars)).to_vector();
+}
+
+/* The equations of the background are evaluated once for both solutions */
+fixed_vector<13> FermionBosonStarTLNBasis::dy_dr(const double r, const fixed_vector<13>& vars) const {
+    const fixed_vector<5> dy_dr = FermionBosonStar::dy_dr(r, vars.sub_range<0, 5>()); // use equations as given in parent class
+    const fixed_vector<6> c = this->perturbation_coefficients(r, vars.sub_range<0, 5>(), dy_dr);
+
+    fixed_vector<13> result({dy_dr[0], dy_dr[1], dy_dr[2], dy_dr[3], dy_dr[4]});
+    for(int k = 5; k < 13; k += 4) {    // H, dH, phi_1, dphi_1 of both solutions
+        const double H = vars[k], dH_dr = vars[k+1], phi_1 = vars[k+2], dphi_1_dr = vars[k+3];
+        result[k] = dH_dr;
+        result[k+1] = c[0]*dH_dr + c[1]*H + c[2]*phi_1;
+        result[k+2] = dphi_1_dr;
+        result[k+3] = c[3]*dphi_1_dr + c[4]*H + c[5]*phi_1;
+    }
+    return result;
+}
+
+int FermionBosonStarTLNBasis::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    if(this->background)
+        return this->integrate_perturbations(2, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    return this->integrate_fixed<FermionBosonStarTLNBasis, 13>(result, events, initial_conditions, intOpts, r_init, r_end, observer);
+}
+
 
 /* This calls the parent class output and adds additional values */
 
@@ -10,39 +10,156 @@ template <typename T>
 void write_MRphi_curve(const std::vector<T>& MRphi_curve, std::string filename);
 */
 
+namespace {
+
+/* log10 of a central density as a feature of the cost model, vanishing densities (e.g. of pure boson stars) lie below the usual range */
+double log_density(const double rho) {
+    return std::log10(std::max(rho, 1e-20));
+}
+
+/* The part of the name of a cost model that tells apart the EoS and the parameters (e.g. mu, lambda) that change the cost of the stars,
+ *  but are the same for all stars of a curve. The EoS have no names, so they are told apart by e(P) and rho(P) at a few pressures */
+std::string cost_model_key(const std::vector<std::shared_ptr<EquationOfState>>& EOS, const std::vector<double>& parameters) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const double x) {
+        const unsigned char* bytes = (const unsigned char*)&x;
+        for(unsigned int k = 0; k < sizeof(double); k++)
+            hash = (hash ^ bytes[k]) * 1099511628211ull;
+    };
+    for(auto it = EOS.begin(); it != EOS.end(); ++it) {
+        add((*it)->min_P());
+        for(int k = -14; k <= 0; k++) {
+            add((*it)->get_e_from_P(std::pow(10., k)));
+            add((*it)->get_rho_from_P(std::pow(10., k)));
+        }
+    }
+    for(auto it = parameters.begin(); it != parameters.end(); ++it)
+        add(*it);
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+    return key;
+}
+
+/* The key of the cost model of a curve of FermionBosonStars, with the EoS, mu and lambda of its first star */
+std::string cost_model_key(const std::vector<FermionBosonStar>& curve) {
+    return curve.empty() ? "" : cost_model_key({curve[0].EOS}, {curve[0].mu, curve[0].lambda});
+}
+
+/* Evaluates the stars with evaluate(i) on the executor, with the cost model (if CostModel::enabled) the most expensive first
+ *  as predicted by the model of the kind of star. The predicted and measured wall time of every star are then recorded
+ *  and written to the history file of the model, they are printed for every star with verbose > 1 and the mean prediction error with verbose > 0.
+ * Without the cost model, the stars are started in their order */
+void evaluate_longest_first(const std::string& model_name, const std::vector<std::string>& feature_names, const std::vector<std::vector<double>>& features,
+                            std::function<void(std::size_t)> evaluate, int verbose) {
+    Executor& executor = Executor::instance();
+    if(!CostModel::enabled) {
+        std::future<void> stars = executor.submit_range(features.size(), evaluate);
+        executor.wait(stars);
+        stars.get();    // passes on the exceptions of the stars
+        return;
+    }
+
+    CostModel& cost_model = CostModel::instance(model_name, feature_names);
+    std::vector<double> predictions;
+    const std::vector<std::size_t> order = cost_model.longest_first(features, predictions);
+
+    // the prediction error of these stars only, the model is shared with the curves that run at the same time
+    std::mutex error_mutex;
+    double error_sum = 0.;
+    unsigned int error_count = 0;
+    std::future<void> stars = executor.submit_ordered(order, [&](std::size_t i) {
+        time_point start{clock_type::now()};
+        evaluate(i);
+        time_point end{clock_type::now()};
+        const double seconds = std::chrono::duration_cast<second_type>(end-start).count();
+        cost_model.record(features[i], seconds);
+        if(predictions[i] > 0. && seconds > 0.) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            error_sum += std::abs(std::log(predictions[i] / seconds));
+            error_count++;
+        }
+        if(verbose > 1)
+            std::cout << "star " << i << ": predicted " << predictions[i] << "s, took " << seconds << "s" << std::endl;
+    });
+    executor.wait(stars);
+
+    if(verbose > 0 && error_count > 0)
+        std::cout << "cost model " << model_name << ": mean |ln(predicted/measured time)| = " << error_sum / error_count << std::endl;
+    cost_model.save();
+    stars.get();    // passes on the exceptions of the stars
+}
+
+/* The value at x_new of the polynomial through the last (up to three) points, i.e. constant, linear or quadratic extrapolation */
+double extrapolate(const std::vector<double>& x, const std::vector<double>& y, const double x_new) {
+    const std::size_t n = std::min<std::size_t>(x.size(), 3), first = x.size() - n;
+    double y_new = 0.;
+    for(std::size_t i = first; i < x.size(); i++) {
+        double l = 1.;
+        for(std::size_t j = first; j < x.size(); j++)
+            if(j != i)
+                l *= (x_new - x[j]) / (x[i] - x[j]);
+        y_new += l * y[i];
+    }
+    return y_new;
+}
+
+/* The mean number of integrations of the searches for omega of the stars */
+double mean_omega_integrations(const std::vector<FermionBosonStar>& stars) {
+    double sum = 0.;
+    for(auto it = stars.begin(); it != stars.end(); ++it)
+        sum += it->omega_integrations;
+    return stars.empty() ? 0. : sum / stars.size();
+}
+
+/* The mean number of evaluations of the searches for rho_0 of the stars */
+double mean_shooting_iterations(const std::vector<NSEinsteinCartan>& stars) {
+    double sum = 0.;
+    for(auto it = stars.begin(); it != stars.end(); ++it)
+        sum += it->shooting_iterations;
+    return stars.empty() ? 0. : sum / stars.size();
+}
+
+}
+
 void FBS::calc_rhophi_curves(std::vector<FermionBosonStar>& MRphi_curve, int verbose) {
 
     const double omega_0 = 1., omega_1 = 10.;  // upper and lower bound for omega in the bisection search
 
-    unsigned int done = 0;
+    std::atomic<unsigned int> done(0);
+
+    std::vector<std::vector<double>> features;
+    for(auto it = MRphi_curve.begin(); it != MRphi_curve.end(); ++it)
+        features.push_back({log_density(it->rho_0), it->phi_0});
 
     time_point start3{clock_type::now()};
-    #pragma omp parallel for schedule(dynamic)
-    for(unsigned int i = 0; i < MRphi_curve.size(); i++) {
+    evaluate_longest_first("FermionBosonStar_" + cost_model_key(MRphi_curve), {"log10_rho_0", "phi_0"}, features, [&](std::size_t i) {
         int bisection_success = MRphi_curve[i].bisection(omega_0, omega_1);  // compute bisection
 		if (bisection_success == -1)
             std::cout << "Bisection failed with omega_0=" << omega_0 << ", omega_1=" << omega_1 << " for " << MRphi_curve[i] << std::endl;
         else
-            MRphi_curve[i].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
+            MRphi_curve[i].evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
 
-        #pragma omp atomic
         done++;
 
         if(verbose >1)
             std::cout << "Progress: "<< float(done) / MRphi_curve.size() * 100.0 << "%" << std::endl;
-    }
+    }, verbose);
     time_point end3{clock_type::now()};
     if(verbose > 0) {
         std::cout << "evaluation of "<< MRphi_curve.size() <<" stars took " << std::chrono::duration_cast<second_type>(end3-start3).count() << "s" << std::endl;
         std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end3-start3).count()/(MRphi_curve.size())) << "s" << std::endl;
+        std::cout << "average number of integrations in the search for omega: " << mean_omega_integrations(MRphi_curve) << std::endl;
+        if(!Executor::instance().is_worker())   // the workspaces can only be read while no other curve runs
+            std::cout << "workspace high-water marks: " << Workspace::total_statistics() << std::endl;
     }
 
 }
 
 // compute curves of constant rho_c and phi_c:
-void FBS::calc_rhophi_curves(double mu, double lambda, std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid, const std::vector<double>& phi_c_grid, std::vector<FermionBosonStar>& MRphi_curve, int verbose) {
+void FBS::calc_rhophi_curves(double mu, double lambda, std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid, const std::vector<double>& phi_c_grid, std::vector<FermionBosonStar>& MRphi_curve, int verbose, bool continuation, FermionBosonStar::omega_solver_method omega_solver) {
 
     FermionBosonStar fbs_model(EOS, mu, lambda, 0.);    // create model for star
+    fbs_model.omega_solver = omega_solver;
     MRphi_curve.clear();
     MRphi_curve.reserve(rho_c_grid.size()*phi_c_grid.size());
 
@@ -55,7 +172,68 @@ void FBS::calc_rhophi_curves(double mu, double lambda, std::shared_ptr<EquationO
         }
     }
 
-    calc_rhophi_curves(MRphi_curve, verbose);
+    if(!continuation) {
+        calc_rhophi_curves(MRphi_curve, verbose);
+        return;
+    }
+
+    const double omega_0 = 1., omega_1 = 10.;  // upper and lower bound for omega in the bisection search, for the first star of every segment
+    Executor& executor = Executor::instance();
+
+    // the grid is walked along rho_c for every phi_c, unless there are too few phi_c for the workers and more lines along phi_c
+    const bool along_rho = phi_c_grid.size() >= executor.size() || phi_c_grid.size() >= rho_c_grid.size();
+    const std::size_t n_lines = along_rho ? phi_c_grid.size() : rho_c_grid.size();
+    const std::size_t line_length = along_rho ? rho_c_grid.size() : phi_c_grid.size();
+    // the lines are split into segments that start with a full bisection each, so that all workers have something to do
+    const std::size_t segments_per_line = std::max<std::size_t>(1, std::min<std::size_t>(line_length / 4, (2*executor.size() + n_lines - 1) / n_lines));
+    const std::size_t segment_length = (line_length + segments_per_line - 1) / segments_per_line;
+
+    std::atomic<unsigned int> done(0);
+
+    time_point start3{clock_type::now()};
+    std::future<void> segments = executor.submit_range(n_lines * segments_per_line, [&](std::size_t s) {
+        const std::size_t line = s / segments_per_line, first = (s % segments_per_line) * segment_length;
+        std::vector<double> x, solved_omega;    // the grid coordinate and omega of the solved stars of the segment
+        double rel_error = 1e-2;    // of the last extrapolation, the range of the next bisection is a few times as large
+
+        for(std::size_t k = first; k < std::min(first + segment_length, line_length); k++) {
+            FermionBosonStar& star = MRphi_curve[along_rho ? line*rho_c_grid.size() + k : k*rho_c_grid.size() + line];
+            const double x_k = along_rho ? rho_c_grid[k] : phi_c_grid[k];
+            double omega_guess = 0.;
+            int bisection_success;
+            if(solved_omega.empty())
+                bisection_success = star.bisection(omega_0, omega_1);
+            else {
+                omega_guess = extrapolate(x, solved_omega, x_k);
+                bisection_success = star.bisection_warm_start(omega_guess, 4.*rel_error, omega_0, omega_1);
+            }
+
+            if (bisection_success == -1) {
+                std::cout << "Bisection failed with omega_0=" << omega_0 << ", omega_1=" << omega_1 << " for " << star << std::endl;
+                x.clear(); solved_omega.clear();    // don't extrapolate over the failed star
+            }
+            else {
+                star.evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
+                if(star.omega > 0.) {
+                    if(omega_guess > 0.)
+                        rel_error = std::max(std::abs(star.omega / omega_guess - 1.), 1e-10);
+                    x.push_back(x_k); solved_omega.push_back(star.omega);
+                }
+            }
+
+            done++;
+            if(verbose >1)
+                std::cout << "Progress: "<< float(done) / MRphi_curve.size() * 100.0 << "%" << std::endl;
+        }
+    });
+    executor.wait(segments);
+    segments.get();    // passes on the exceptions of the stars
+    time_point end3{clock_type::now()};
+    if(verbose > 0) {
+        std::cout << "evaluation of "<< MRphi_curve.size() <<" stars in " << n_lines * segments_per_line << " segments with continuation took " << std::chrono::duration_cast<second_type>(end3-start3).count() << "s" << std::endl;
+        std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end3-start3).count()/(MRphi_curve.size())) << "s" << std::endl;
+        std::cout << "average number of integrations in the search for omega: " << mean_omega_integrations(MRphi_curve) << std::endl;
+    }
 }
 
 
@@ -76,18 +254,20 @@ void FBS::calc_NbNf_curves(double mu, double lambda, std::shared_ptr<EquationOfS
     // compute the MR-diagrams:
     double omega_0 = 1., omega_1 = 10.;
 
-    unsigned int done = 0;
+    std::atomic<unsigned int> done(0);
 
-    #pragma omp parallel for schedule(dynamic, 10)
-    for(unsigned i = 0; i < NbNf_grid.size(); i++) {
-        for(unsigned j = 0; j < rho_c_grid.size() ; j++) {
-            int index = i*rho_c_grid.size() + j;
-            MRphi_curve[index].shooting_NbNf_ratio(NbNf_grid[i], 1e-4, omega_0, omega_1);  // compute star with set NbNf ratio
-            //MRphi_curve[index].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
+    std::vector<std::vector<double>> features;
+    for(unsigned int index = 0; index < MRphi_curve.size(); index++)
+        features.push_back({log_density(MRphi_curve[index].rho_0), NbNf_grid[index / rho_c_grid.size()]});
 
-            std::cout << "Progress: "<< float(done) / (NbNf_grid.size() * rho_c_grid.size()) * 100.0 << "%" << std::endl;
-        }
-    }
+    evaluate_longest_first("FermionBosonStar_NbNf_" + cost_model_key({EOS}, {mu, lambda}), {"log10_rho_0", "NbNf"}, features, [&](std::size_t index) {
+        const unsigned int i = index / rho_c_grid.size();
+        MRphi_curve[index].shooting_NbNf_ratio(NbNf_grid[i], 1e-4, omega_0, omega_1);  // compute star with set NbNf ratio
+        //MRphi_curve[index].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
+
+        done++;
+        std::cout << "Progress: "<< float(done) / (NbNf_grid.size() * rho_c_grid.size()) * 100.0 << "%" << std::endl;
+    }, 1);
 
     std::cout << "end loop" << std::endl;
 }
@@ -95,7 +275,7 @@ void FBS::calc_NbNf_curves(double mu, double lambda, std::shared_ptr<EquationOfS
 
 // compute the tidal love number for curves of constant rho_c and phi_c:
 // the calculation of the unperturbed solution must be performed before, and only then this function can be called because it uses the equilibrium results from calc_rhophi_curves()
-void FBS::calc_MRphik2_curve(const std::vector<FermionBosonStar>& MRphi_curve,  std::vector<FermionBosonStarTLN>& MRphik2_curve, int verbose) {
+void FBS::calc_MRphik2_curve(const std::vector<FermionBosonStar>& MRphi_curve,  std::vector<FermionBosonStarTLN>& MRphik2_curve, int verbose, bool superposition, bool reuse_background) {
 
 	MRphik2_curve.clear();  MRphik2_curve.reserve(MRphi_curve.size());
 
@@ -105,27 +285,35 @@ void FBS::calc_MRphik2_curve(const std::vector<FermionBosonStar>& MRphi_curve,
         MRphik2_curve.push_back(fbs);
     }
 
-    double phi_1_0, phi_1_1; // upper and lower bound for the bisection of the perturbed Phi-field
+    std::atomic<unsigned int> done(0);
 
-    unsigned int done = 0;
+    std::vector<std::vector<double>> features;
+    for(auto it = MRphi_curve.begin(); it != MRphi_curve.end(); ++it)
+        features.push_back({log_density(it->rho_0), it->phi_0});
 
     time_point start3{clock_type::now()};
-	#pragma omp parallel for schedule(dynamic, 10)
-    for(unsigned int i = 0; i < MRphi_curve.size(); i++) {
+    evaluate_longest_first("FermionBosonStarTLN_" + cost_model_key(MRphi_curve), {"log10_rho_0", "phi_0"}, features, [&](std::size_t i) {
         //FermionBosonStarTLN fbstln(*it);
-        phi_1_0 = 1e-3 * MRphi_curve[i].phi_0;
-        phi_1_1 = 1e6 * MRphi_curve[i].phi_0;
-        int bisection_success = MRphik2_curve[i].bisection_phi_1(phi_1_0, phi_1_1);
+        if(reuse_background) {  // integrate the background of the parent star once for all integrations of the perturbations
+            Workspace& workspace = Workspace::thread_local_instance();
+            integrator::Trajectory& background = workspace.trajectory(0);
+            FermionBosonStar parent(MRphi_curve[i]);
+            parent.evaluate_model(background, integrator::IntegrationOptions(), "", &workspace);
+            MRphik2_curve[i].set_background(background);
+        }
+        double phi_1_0 = 1e-3 * MRphi_curve[i].phi_0; // upper and lower bound for the bisection of the perturbed Phi-field
+        double phi_1_1 = 1e6 * MRphi_curve[i].phi_0;
+        int bisection_success = superposition ? MRphik2_curve[i].superposition_phi_1() : MRphik2_curve[i].bisection_phi_1(phi_1_0, phi_1_1);
         if (bisection_success == 0)
             MRphik2_curve[i].evaluate_model();
+        MRphik2_curve[i].clear_background();   // the memory of the background isn't needed anymore
         //MRphik2_curve[i].push_back(fbstln);
 
-        #pragma omp atomic
         done++;
 
         if(verbose >1)
             std::cout << "Progress: "<< float(done) / MRphi_curve.size() * 100.0 << "%" << std::endl;
-    }
+    }, verbose);
 
     time_point end3{clock_type::now()};
     if(verbose > 0) {
@@ -150,19 +338,24 @@ void FBS::calc_twofluidFBS_curves(std::shared_ptr<EquationOfState> EOS1, std::sh
         }
     }
 
-	time_point start3{clock_type::now()};
-	// integrate all the stars in parallel:
-    #pragma omp parallel for
-    for(unsigned int i = 0; i < MRphi_curve.size(); i++) {
-        MRphi_curve[i].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
-    }
+    std::vector<std::vector<double>> features;
+    for(auto it = MRphi_curve.begin(); it != MRphi_curve.end(); ++it)
+        features.push_back({log_density(it->rho1_0), log_density(it->rho2_0)});
+
+    time_point start3{clock_type::now()};
+    // integrate all the stars in parallel:
+    evaluate_longest_first("TwoFluidFBS_" + cost_model_key({EOS1, EOS2}, {mu, lambda}), {"log10_rho1_0", "log10_rho2_0"}, features, [&](std::size_t i) {
+        MRphi_curve[i].evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
+    }, 1);
     time_point end3{clock_type::now()};
     std::cout << "evaluation of "<< MRphi_curve.size() <<" stars took " << std::chrono::duration_cast<second_type>(end3-start3).count() << "s" << std::endl;
     std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end3-start3).count()/(MRphi_curve.size())) << "s" << std::endl;
+    if(!Executor::instance().is_worker())   // the workspaces can only be read while no other curve runs
+        std::cout << "workspace high-water marks: " << Workspace::total_statistics() << std::endl;
 
 }
 
-void FBS::calc_EinsteinCartan_curves(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, double beta, double gamma, int verbose) {
+void FBS::calc_EinsteinCartan_curves(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, double beta, double gamma, int verbose, bool lockstep) {
 
 	NSEinsteinCartan ec_model(EOS, 0.0, beta, gamma);	// create model for star
 
@@ -178,23 +371,36 @@ void FBS::calc_EinsteinCartan_curves(std::shared_ptr<EquationOfState> EOS, const
 
 	// integrate all the stars in parallel:
 	time_point start{clock_type::now()};
-	unsigned int done = 0;
-    #pragma omp parallel for schedule(dynamic, 10)
-    for(unsigned int i = 0; i < MR_curve.size(); i++) {
-        MR_curve[i].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
+	std::atomic<unsigned int> done(0);
+	Executor& executor = Executor::instance();
+	if(lockstep) {
+		std::atomic<unsigned int> next(0);	// the next star in the list, shared by the workers
+		std::future<void> stars = executor.submit_range(executor.size(), [&](std::size_t) { NSEinsteinCartan::evaluate_models(MR_curve, next); });
+		executor.wait(stars);
+		stars.get();    // passes on the exceptions of the stars
+	}
+	else {
+        std::vector<std::vector<double>> features;
+        for(auto it = MR_curve.begin(); it != MR_curve.end(); ++it)
+            features.push_back({log_density(it->rho_0), it->beta, it->gamma});
 
-		#pragma omp atomic
-        done++;
-        if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
-    }
+        evaluate_longest_first("NSEinsteinCartan_" + cost_model_key({EOS}, {}), {"log10_rho_0", "beta", "gamma"}, features, [&](std::size_t i) {
+            MR_curve[i].evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
+
+            done++;
+            if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
+        }, verbose);
+	}
     time_point end{clock_type::now()};
 	if(verbose > 0) {
     std::cout << "evaluation of "<< MR_curve.size() <<" stars took " << std::chrono::duration_cast<second_type>(end-start).count() << "s" << std::endl;
     std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end-start).count()/(MR_curve.size())) << "s" << std::endl;
+    if(!executor.is_worker())   // the workspaces can only be read while no other curve runs
+        std::cout << "workspace high-water marks: " << Workspace::total_statistics() << std::endl;
 	}
 }
 
-void FBS::calc_EinsteinCartan_curves_beta_grid(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma, int verbose) {
+void FBS::calc_EinsteinCartan_curves_beta_grid(std::shared_ptr<EquationOfState> EOS, const std::vector<double>& rho_c_grid,std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma, int verbose, bool lockstep) {
 
 	NSEinsteinCartan ec_model(EOS, 0.0, beta_grid[0], gamma);	// create model for star
 
@@ -210,19 +416,32 @@ void FBS::calc_EinsteinCartan_curves_beta_grid(std::shared_ptr<EquationOfState>
 
 	// integrate all the stars in parallel:
 	time_point start{clock_type::now()};
-	unsigned int done = 0;
-    #pragma omp parallel for schedule(dynamic, 10)
-    for(unsigned int i = 0; i < MR_curve.size(); i++) {
-        MR_curve[i].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
+	std::atomic<unsigned int> done(0);
+	Executor& executor = Executor::instance();
+	if(lockstep) {
+		std::atomic<unsigned int> next(0);	// the next star in the list, shared by the workers
+		std::future<void> stars = executor.submit_range(executor.size(), [&](std::size_t) { NSEinsteinCartan::evaluate_models(MR_curve, next); });
+		executor.wait(stars);
+		stars.get();    // passes on the exceptions of the stars
+	}
+	else {
+        std::vector<std::vector<double>> features;
+        for(auto it = MR_curve.begin(); it != MR_curve.end(); ++it)
+            features.push_back({log_density(it->rho_0), it->beta, it->gamma});
 
-		#pragma omp atomic
-        done++;
-        if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
-    }
+        evaluate_longest_first("NSEinsteinCartan_" + cost_model_key({EOS}, {}), {"log10_rho_0", "beta", "gamma"}, features, [&](std::size_t i) {
+            MR_curve[i].evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
+
+            done++;
+            if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
+        }, verbose);
+	}
     time_point end{clock_type::now()};
 	if(verbose > 0) {
     std::cout << "evaluation of "<< MR_curve.size() <<" stars took " << std::chrono::duration_cast<second_type>(end-start).count() << "s" << std::endl;
     std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end-start).count()/(MR_curve.size())) << "s" << std::endl;
+    if(!executor.is_worker())   // the workspaces can only be read while no other curve runs
+        std::cout << "workspace high-water marks: " << Workspace::total_statistics() << std::endl;
 	}
 }
 
@@ -242,24 +461,28 @@ void FBS::calc_EinsteinCartan_curves_rotation_beta_grid(std::shared_ptr<Equation
 
 	// integrate all the stars in parallel:
 	time_point start{clock_type::now()};
-	unsigned int done = 0;
-    #pragma omp parallel for schedule(dynamic, 10)
-    for(unsigned int i = 0; i < MR_curve.size(); i++) {
-        MR_curve[i].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
+	std::atomic<unsigned int> done(0);
+    std::vector<std::vector<double>> features;
+    for(auto it = MR_curve.begin(); it != MR_curve.end(); ++it)
+        features.push_back({log_density(it->rho_0), it->beta});
+
+    evaluate_longest_first("NSEinsteinCartanRotation_" + cost_model_key({EOS}, {}), {"log10_rho_0", "beta"}, features, [&](std::size_t i) {
+        MR_curve[i].evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
 
-		#pragma omp atomic
         done++;
         if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
-    }
+    }, verbose);
     time_point end{clock_type::now()};
 	if(verbose > 0) {
     std::cout << "evaluation of "<< MR_curve.size() <<" stars took " << std::chrono::duration_cast<second_type>(end-start).count() << "s" << std::endl;
     std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end-start).count()/(MR_curve.size())) << "s" << std::endl;
+    if(!Executor::instance().is_worker())   // the workspaces can only be read while no other curve runs
+        std::cout << "workspace high-water marks: " << Workspace::total_statistics() << std::endl;
 	}
 }
 
 
-void FBS::calc_EinsteinCartan_curves_const_mass(std::shared_ptr<EquationOfState> EOS, double rho_c_init, std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma, double wanted_mass, std::string quantity_label, int verbose) {
+void FBS::calc_EinsteinCartan_curves_const_mass(std::shared_ptr<EquationOfState> EOS, double rho_c_init, std::vector<NSEinsteinCartan>& MR_curve, const std::vector<double>& beta_grid, double gamma, double wanted_mass, std::string quantity_label, int verbose, bool continuation) {
 
 	NSEinsteinCartan ec_model(EOS, 0.0, beta_grid[0], gamma);	// create model for star
 
@@ -275,19 +498,63 @@ void FBS::calc_EinsteinCartan_curves_const_mass(std::shared_ptr<EquationOfState>
 
 	// integrate all the stars in parallel:
 	time_point start{clock_type::now()};
-	unsigned int done = 0;
-    #pragma omp parallel for schedule(dynamic, 10)
-    for(unsigned int i = 0; i < MR_curve.size(); i++) {
-        MR_curve[i].shooting_constant_Mass(wanted_mass, quantity_label);
-        MR_curve[i].evaluate_model();   // evaluate the model but do not save the intermediate data into txt file
-
-		#pragma omp atomic
-        done++;
-        if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
+	std::atomic<unsigned int> done(0);
+    if(!continuation) {
+        std::vector<std::vector<double>> features;
+        for(auto it = MR_curve.begin(); it != MR_curve.end(); ++it)
+            features.push_back({it->beta, it->gamma, wanted_mass});
+
+        evaluate_longest_first("NSEinsteinCartan_const_mass_" + cost_model_key({EOS}, {}), {"beta", "gamma", "wanted_mass"}, features, [&](std::size_t i) {
+            MR_curve[i].shooting_constant_Mass(wanted_mass, quantity_label);
+            MR_curve[i].evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
+
+            done++;
+            if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
+        }, verbose);
+    }
+    else {
+        // the beta grid is split into segments that start with a full search each, so that all workers have something to do
+        Executor& executor = Executor::instance();
+        const std::size_t n_segments = std::max<std::size_t>(1, std::min<std::size_t>(MR_curve.size() / 4, 2*executor.size()));
+        const std::size_t segment_length = (MR_curve.size() + n_segments - 1) / n_segments;
+
+        std::future<void> segments = executor.submit_range(n_segments, [&](std::size_t s) {
+            std::vector<double> x, solved_rho_0;    // beta and rho_0 of the solved stars of the segment
+            double rel_error = 1e-2;    // of the last extrapolation, the first range of the next search is a few times as large
+
+            for(std::size_t i = s*segment_length; i < std::min((s + 1)*segment_length, MR_curve.size()); i++) {
+                NSEinsteinCartan& star = MR_curve[i];
+                double rho_0_guess = 0.;
+                if(solved_rho_0.empty())
+                    star.shooting_constant_Mass(wanted_mass, quantity_label);
+                else {
+                    rho_0_guess = extrapolate(x, solved_rho_0, star.beta);
+                    star.shooting_constant_Mass_warm_start(wanted_mass, quantity_label, rho_0_guess, 4.*rel_error);
+                }
+                star.evaluate_model(Workspace::thread_local_instance());   // evaluate the model but do not save the intermediate data into txt file
+
+                if(star.rho_0 > 0.) {
+                    if(rho_0_guess > 0.)
+                        rel_error = std::max(std::abs(star.rho_0 / rho_0_guess - 1.), 1e-6);
+                    x.push_back(star.beta); solved_rho_0.push_back(star.rho_0);
+                }
+                else {  // the mass is not attainable, don't extrapolate over the star
+                    x.clear(); solved_rho_0.clear();
+                }
+
+                done++;
+                if(verbose > 1) {std::cout << "Progress: "<< float(done) / MR_curve.size() * 100.0 << "%" << std::endl;}
+            }
+        });
+        executor.wait(segments);
+        segments.get();    // passes on the exceptions of the stars
     }
     time_point end{clock_type::now()};
 	if(verbose > 0) {
     std::cout << "evaluation of "<< MR_curve.size() <<" stars took " << std::chrono::duration_cast<second_type>(end-start).count() << "s" << std::endl;
     std::cout << "average time per evaluation: " << (std::chrono::duration_cast<second_type>(end-start).count()/(MR_curve.size())) << "s" << std::endl;
+    std::cout << "average number of evaluations in the search for rho_0: " << mean_shooting_iterations(MR_curve) << std::endl;
+    if(!Executor::instance().is_worker())   // the workspaces can only be read while no other curve runs
+        std::cout << "workspace high-water marks: " << Workspace::total_statistics() << std::endl;
 	}
 }
\ No newline at end of file
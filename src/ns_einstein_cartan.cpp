@@ -12,6 +12,9 @@ const integrator::Event NSEinsteinCartan::Pressure_zero = integrator::Event([](c
 // Event to stop the integration when the pressure diverges (derivative gets positive)
 const integrator::Event NSEinsteinCartan::Pressure_diverging = integrator::Event([](const double r, const double dr, const vector &y, const vector &dy, const void *params)
                                                                            { return ((dy[2] > 0.0) ); }, true);
+// Event to locate the surface of the star accurately, where the radius R_NS is read off (see calculate_star_parameters)
+const integrator::Event NSEinsteinCartan::P_min_reached = integrator::Event([](const double r, const double dr, const vector &y, const vector &dy, const void *params)
+                                                                           { return (y[2] < std::max(P_ns_min, ((NSEinsteinCartan*)params)->EOS->min_P())); }, false, "P_min_reached", 1e-5);
 
 // initial conditions for two arbitrary fluids
 vector NSEinsteinCartan::get_initial_conditions(const double r_init) const {
@@ -20,13 +23,32 @@ vector NSEinsteinCartan::get_initial_conditions(const double r_init) const {
 }
 
 vector NSEinsteinCartan::dy_dr(const double r, const vector &vars) const {
+    return this->dy_dr(r, fixed_vector<3>(vars)).to_vector();
+}
+
+fixed_vector<3> NSEinsteinCartan::dy_dr(const double r, const fixed_vector<3> &vars) const {
+    return this->dy_dr(r, vars, *(this->EOS));
+}
+
+namespace {
+
+/* The equations for a, alpha, P with the total energy density etot, the spin density s2 = s^2 and its derivative s2_prime by P
+ * They are shared by dy_dr and the lanes of evaluate_models, which compute the same values */
+inline void einstein_cartan_equations(const double r, const double a, const double alpha, const double P, const double etot,
+                                        const double s2, const double s2_prime, double& da_dr, double& dalpha_dr, double& dP_dr) {
+	da_dr = 0.5* a *      ( (1.-a*a) / r + 8.*M_PI*r*a*a*( etot - 8.*M_PI*s2 ) );
+    dalpha_dr = 0.5* alpha * ( (a*a-1.) / r + 8.*M_PI*r*a*a*( P - 8.*M_PI*s2 ) );
+	dP_dr = -(etot + P - 16.*M_PI*s2)/(1. - 8.*M_PI* s2_prime) * dalpha_dr/alpha;
+}
+
+}
+
+template <typename E>
+fixed_vector<3> NSEinsteinCartan::dy_dr(const double r, const fixed_vector<3> &vars, E& myEOS) const {
 
 	// rename variables for convenience
     const double a = vars[0], alpha = vars[1]; double P = vars[2];
 
-    // load the EOS for the NS fluid:
-    EquationOfState &myEOS = *(this->EOS);
-
     // call the EOS and compute the wanted values:
     double etot=0.;	// total energy density of the fluid
     if (P <= 0. || P < myEOS.min_P()) {
@@ -42,118 +64,282 @@ vector NSEinsteinCartan::dy_dr(const double r, const vector &vars) const {
 	double s2_prime = this->beta*this->gamma*std::pow(P, this->gamma - 1.); // derivative of s^2 with respect to P
 
 	// compute the ODE:
-	double da_dr = 0.5* a *      ( (1.-a*a) / r + 8.*M_PI*r*a*a*( etot - 8.*M_PI*s2 ) );
-    double dalpha_dr = 0.5* alpha * ( (a*a-1.) / r + 8.*M_PI*r*a*a*( P - 8.*M_PI*s2 ) );
-	double dP_dr = -(etot + P - 16.*M_PI*s2)/(1. - 8.*M_PI* s2_prime) * dalpha_dr/alpha;
+	fixed_vector<3> dy;
+	einstein_cartan_equations(r, a, alpha, P, etot, s2, s2_prime, dy[0], dy[1], dy[2]);
+    return dy;
+}
+
+int NSEinsteinCartan::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    return dispatch_eos(*(this->EOS), [&](auto& myEOS) {
+        const auto rhs = [this, &myEOS](const double r, const fixed_vector<3>& y, const void*) { return this->dy_dr(r, y, myEOS); };
+        return this->integrate_fixed<3>(rhs, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    });
+}
 
-    return vector({da_dr, dalpha_dr, dP_dr});
+/***********************
+ * NSEinsteinCartanObserver *
+ ***********************/
+
+void NSEinsteinCartanObserver::reset() {
+    M_T = 0.; R_NS = 0.; R_99 = 0.; M_rest = 0.;
+    surface_found = false;
+    steps = 0;
+    r_last = 0.; a_last = 1.; N_F_integrand_last = 0.;
+    outer_shell().clear();
+    first = 0;
 }
 
-void NSEinsteinCartan::calculate_star_parameters(const std::vector<integrator::step> &results, const std::vector<integrator::Event> &events) {
+void NSEinsteinCartanObserver::observe(const double r, const vector& y, const vector& dy) {
 
-    // compute all values of the star, including mass and radius:
-    int last_index = results.size() - 1; // last index in the integration
+    // P = y[2]
+    double rho = 0., eps;
+    if (!(y[2] < P_ns_min || y[2] < this->EOS->min_P()))
+        this->EOS->callEOS(rho, eps, y[2]);
+    this->observe(r, y[0], y[2], rho);
+}
+
+void NSEinsteinCartanObserver::observe(const double r, const double a, const double P, const double rho_at_P) {
 
 	// we stop the integration when the pressure reaches zero. This corresponds to the radius of the NS.
-	// we extract the total gravitational mass M_T also at this point (outside of the NS is just Schwarzschild):
-	//R_NS = results[last_index].first;
-	for (unsigned i = 1; i < results.size(); i++) {
-        if (results[i].second[2] < P_ns_min || results[i].second[2] < this->EOS->min_P()) {
-            R_NS = results[i].first; // radius uf NS
-            break;
-        }
+    const bool outside = P < P_ns_min || P < this->EOS->min_P();
+    if (steps > 0 && !surface_found && outside) {
+        R_NS = r; // radius uf NS
+        surface_found = true;
     }
-	M_T = results[last_index].first / 2. * (1. - 1./pow(results[last_index].second[0], 2));	// M = R/2 * (1 - 1/ a(R)^2 )
-	double C = M_T / R_NS; // compactness of the NS
 
 	// compute the total restmass of the NS using the conserved Noether current (conservation of fluid flow: J^mu = rho u^mu)
-    std::vector<double> r(results.size()), N_F_integrand(results.size());
-    vector v;
-    double rho, eps;
-	// compute restmass at each r:
-    for(unsigned int i = 0; i < results.size(); i++) {
-        r[i] = results[i].first;
-        v = results[i].second;
-        // P = v[2]
-        if (v[2] < P_ns_min || v[2] < this->EOS->min_P()) {rho = 0.;}
-        else {this->EOS->callEOS(rho, eps, v[2]);}
-        N_F_integrand[i] = 4.*M_PI * v[0] * rho * r[i] * r[i];
-	}
-    // integrate:
-    std::vector<double> N_F_integrated;
-    integrator::cumtrapz(r, N_F_integrand, N_F_integrated);
-    // compute the restmass density:
-    double N_F =  N_F_integrated[last_index];
-
-    // compute radius where 99% of the restmass is contained:
-	// find index where this happens
-	int i_F = 0;
-    for(int i = 1; i < last_index; i++) {
-        if(N_F_integrated[i] < 0.99*N_F) {i_F++;}       
+    const double rho = outside ? 0. : rho_at_P;
+    const double N_F_integrand = 4.*M_PI * a * rho * r * r;
+    // integrate with the trapezoidal rule:
+    if (steps > 0)
+        M_rest += (r - r_last) * (N_F_integrand + N_F_integrand_last)/2.;
+
+    // the steps in the outer 1% of the rest mass are needed for R_99, keep the last step below as well
+    std::vector<double>& shell = outer_shell();
+    shell.push_back(r); shell.push_back(M_rest);
+    while (shell.size() > 2*first + 2 && shell[2*first + 3] < 0.99*M_rest)
+        first++;
+    if (2*first >= shell.size()/2) {   // remove the steps below when they take up half of the vector, this keeps its capacity
+        shell.erase(shell.begin(), shell.begin() + 2*first);
+        first = 0;
     }
-    // obtain radius from corresponding index:
-    double R_99 = results[i_F].first;
 
-    // ---------------------------------------------------------------------------------
+    r_last = r; a_last = a; N_F_integrand_last = N_F_integrand;
+    steps++;
+}
+
+void NSEinsteinCartanObserver::finalize() {
+	// we extract the total gravitational mass M_T at the last step (outside of the NS is just Schwarzschild):
+	M_T = r_last / 2. * (1. - 1./pow(a_last, 2));	// M = R/2 * (1 - 1/ a(R)^2 )
+
+    // compute radius where 99% of the restmass is contained, interpolated linearly between the steps:
+    const std::vector<double>& shell = outer_shell();
+    if (shell.size() <= 2*first)
+        return;
+    const double* step = shell.data() + 2*first;   // r and M_rest of the last step below 0.99*M_rest, followed by the next step
+    R_99 = step[0];
+    if (shell.size() > 2*first + 2 && step[3] > step[1])
+        R_99 += (step[2] - step[0]) * (0.99*M_rest - step[1]) / (step[3] - step[1]);
+}
+
+
+/***********************
+ * NSEinsteinCartan *
+ ***********************/
+
+/* This function takes the result of an integration and calculates the star properties
+ * The steps are passed to the NSEinsteinCartanObserver, which is used directly during the integration in evaluate_model().
+ * The restmass densities of all steps are computed in one call of the EoS */
+void NSEinsteinCartan::calculate_star_parameters(const integrator::Trajectory &results, const std::vector<integrator::Event> &events) {
+
+    NSEinsteinCartanObserver observer(this->EOS);
+    const std::vector<double>& a = results.column(0), &P = results.column(2);
+    std::vector<double> rho(results.size()), eps(results.size());
+    this->EOS->callEOS_batch(P.data(), rho.data(), eps.data(), results.size());
+    for (unsigned i = 0; i < results.size(); i++)
+        observer.observe(results.r(i), a[i], P[i], rho[i]);
+    observer.finalize();
+    this->set_star_parameters(observer);
+}
 
+void NSEinsteinCartan::set_star_parameters(const NSEinsteinCartanObserver& observer) {
     // update all the global star values:
-    this->M_T = M_T;	// total gravitational mass
-    this->R_99 = R_99;	// radius where 99% of restmass is contained (also calles 'tidal radius')
-    this->R_NS = R_NS;	// radius of NS
-    this->C = C;		// compactness
-    this->M_rest = N_F;	// total restmass
+    this->M_T = observer.M_T;	// total gravitational mass
+    this->R_99 = observer.R_99;	// radius where 99% of restmass is contained (also calles 'tidal radius')
+    if (observer.surface_found)
+        this->R_NS = observer.R_NS;	// radius of NS
+    this->C = this->M_T / this->R_NS;		// compactness of the NS
+    this->M_rest = observer.M_rest;	// total restmass
 }
 
+/* Integrates the star without saving the steps, the star parameters are computed during the integration */
 void NSEinsteinCartan::evaluate_model() {
 
-    std::vector<integrator::step> results;
-    this->evaluate_model(results);
+    Workspace workspace;
+    this->evaluate_model(workspace);
+}
+
+void NSEinsteinCartan::evaluate_model(Workspace& workspace) {
+
+    integrator::IntegrationOptions intOpts;
+    std::vector<integrator::Event>& events = workspace.events();
+    events.push_back(Pressure_zero); events.push_back(Pressure_diverging); events.push_back(P_min_reached);
+    integrator::Trajectory& results = workspace.trajectory(0);
+    NSEinsteinCartanObserver observer(this->EOS, &workspace.array(0, 0));
+
+    this->integrate(results, events, this->get_initial_conditions(), intOpts, -1., -1., &observer);
+    observer.finalize();
+    this->set_star_parameters(observer);
 }
 
-void NSEinsteinCartan::evaluate_model(std::vector<integrator::step> &results, std::string filename) {
+/* Every lane has its own copy of the events and its own observer. The parameters beta, gamma and the interval of the last lookup
+ *  in the EoS are kept for every lane, the stars of the lanes are in different parts of the table */
+template <typename E>
+class NSEinsteinCartan::Lanes {
+public:
+    static constexpr std::size_t L = integrator::lockstep_lanes;
+
+    Lanes(std::vector<NSEinsteinCartan>& stars, std::atomic<unsigned int>& next_star, E& myEOS)
+        : stars(stars), next_star(next_star), myEOS(myEOS), EOS(stars[0].EOS), observers(L, NSEinsteinCartanObserver(stars[0].EOS)) {
+        for(unsigned int l = 0; l < L; l++) {
+            events[l] = {Pressure_zero, Pressure_diverging, P_min_reached};
+            beta[l] = 0.; gamma[l] = 1.; hints[l] = 1;
+        }
+    }
+
+    bool next(const unsigned int l, integrator::Lane<3>& lane, double& r0, fixed_vector<3>& y0) {
+        while(true) {
+            const unsigned int i = next_star++;
+            if(i >= stars.size())
+                return false;
+            NSEinsteinCartan& star = stars[i];
+            if(star.EOS != EOS) {
+                star.evaluate_model();
+                continue;
+            }
+            lane.id = i;
+            lane.r_end = star.r_end;
+            lane.params = &star;
+            lane.events = &events[l];
+            lane.observer = &observers[l];
+            observers[l].reset();
+            beta[l] = star.beta; gamma[l] = star.gamma;
+            r0 = star.r_init;
+            y0 = fixed_vector<3>(star.get_initial_conditions());
+            return true;
+        }
+    }
+
+    void finish(const unsigned int l, const integrator::Lane<3>& lane, const double r, const fixed_vector<3>& y, const int reason) {
+        observers[l].finalize();
+        stars[lane.id].set_star_parameters(observers[l]);
+    }
+
+    fixed_vector<3> operator()(const double r, const fixed_vector<3>& y, const void* params) const {
+        return ((const NSEinsteinCartan*)params)->dy_dr(r, y, myEOS);
+    }
+
+    /* The same as dy_dr for every lane. The EoS is called for all lanes at once and ignored for the lanes outside of the star */
+    void dy_dr_lanes(const double (&r)[L], const double (&y)[3][L], double (&dy)[3][L]) {
+        double P[L], e[L], s2[L], s2_prime[L];
+        bool outside[L];
+        const double P_min = myEOS.min_P();
+        for(unsigned int l = 0; l < L; l++) {
+            outside[l] = y[2][l] <= 0. || y[2][l] < P_min;
+            P[l] = outside[l] ? 0. : y[2][l];
+        }
+        myEOS.e_from_P_lanes(P, e, hints, L);
+        for(unsigned int l = 0; l < L; l++) {
+            s2[l] = beta[l] * std::pow(P[l], gamma[l]);
+            s2_prime[l] = beta[l]*gamma[l]*std::pow(P[l], gamma[l] - 1.);
+        }
+        #pragma omp simd
+        for(unsigned int l = 0; l < L; l++)
+            einstein_cartan_equations(r[l], y[0][l], y[1][l], P[l], outside[l] ? 0. : e[l], s2[l], s2_prime[l], dy[0][l], dy[1][l], dy[2][l]);
+    }
+
+private:
+    std::vector<NSEinsteinCartan>& stars;
+    std::atomic<unsigned int>& next_star;
+    E& myEOS;
+    std::shared_ptr<EquationOfState> EOS;
+    std::vector<integrator::Event> events[L];
+    std::vector<NSEinsteinCartanObserver> observers;
+    double beta[L], gamma[L];
+    std::size_t hints[L];
+};
+
+void NSEinsteinCartan::evaluate_models(std::vector<NSEinsteinCartan>& stars, std::atomic<unsigned int>& next) {
+
+    if(stars.empty())
+        return;
+    integrator::IntegrationOptions intOpts;
+    intOpts.method = integrator::dopri5;    // the lanes take the steps of the Dormand-Prince stepper
+    dispatch_eos(*(stars[0].EOS), [&](auto& myEOS) {
+        Lanes<typename std::remove_reference<decltype(myEOS)>::type> lanes(stars, next, myEOS);
+        integrator::lockstep_DoPri5<3, integrator::lockstep_lanes>(lanes, intOpts);
+    });
+}
+
+void NSEinsteinCartan::evaluate_model(integrator::Trajectory &results, std::string filename) {
 
     // define variables used in the integrator and events during integration:
     integrator::IntegrationOptions intOpts;
     intOpts.save_intermediate = true;
-    intOpts.max_stepsize = 1e-3; // smaller stepsize is needed to computethe radius more accurately
-    // stop integration if pressure is zero:
-    std::vector<integrator::Event> events = {Pressure_zero, Pressure_diverging};
+    // stop integration if pressure is zero, the radius is located by P_min_reached:
+    std::vector<integrator::Event> events = {Pressure_zero, Pressure_diverging, P_min_reached};
     results.clear();
 
     this->integrate(results, events, this->get_initial_conditions(), intOpts); // integrate the star
 
+    this->calculate_star_parameters(results, events);
+
     // option to save all the radial profiles into a txt file:
     if (!filename.empty())
     {
-		// add two columns for the energy density and restmass density to the results array:
-		for(unsigned i=0; i< results.size(); i++) {
-			results[i].second = vector({results[i].second[0], results[i].second[1], results[i].second[2], this->EOS->get_e_from_P(results[i].second[2]), this->EOS->get_rho_from_P(results[i].second[2])});
-		}
+		// add two columns for the energy density and restmass density to the results:
+		const std::vector<double>& P = results.column(2);
+		std::vector<double> e(results.size()), rho(results.size());
+		this->EOS->e_from_P_batch(P.data(), e.data(), results.size());
+		this->EOS->rho_from_P_batch(P.data(), rho.data(), results.size());
+		results.add_column(e);
+		results.add_column(rho);
         plotting::save_integration_data(results, {0, 1, 2, 3, 4}, {"a", "alpha", "P", "e", "rho"}, filename);
     }
+}
 
-    this->calculate_star_parameters(results, events);
+double NSEinsteinCartan::max_possible_density() const {
+    if (this->beta > 0.0)
+        return this->EOS->get_rho_from_P(pow(8.*M_PI*this->beta*this->gamma, 1./(1.-this->gamma)));
+    return 10.;
 }
 
 void NSEinsteinCartan::shooting_constant_Mass(double wanted_mass, std::string quantity_label, double accuracy, int max_steps) {
     // failsafe checks:
     //std::cout << quantity_label << this->get_quantity(quantity_label) << std::endl; std::exit(0);
     if (!( (quantity_label == "M_T") || (quantity_label == "M_rest") )) { std::cout << "Error: only searches for 'M_T' and 'M_rest' are implemented. quitting function" << std::endl; return;}
+    // the mass is read through a pointer to the member instead of looking up the label after every evaluation
+    double NSEinsteinCartan::* const mass = (quantity_label == "M_T") ? &NSEinsteinCartan::M_T : &NSEinsteinCartan::M_rest;
+    Workspace& workspace = Workspace::thread_local_instance();
+    this->shooting_iterations = 0;
+    auto evaluate = [&] () {
+        this->evaluate_model(workspace);
+        this->shooting_iterations++;
+        return this->*mass;
+    };
     // calc the FBS solution once using an initial rho0 value
     double my_MT = 0.0;
     double rho_0_init = this->rho_0;
 
     // failsafe check in case that the wanted mass is not attainable with the maximum possible density/pressure, given by 8pi*beta*gamma*p^(gamma-1) == 1
     // first compute the star at the highest possible density (rather with density an epsilon smaller to be numerically unproblematic to compute):
-    double max_possible_densiy = 10.;
+    double max_possible_densiy = this->max_possible_density();
     if (this->beta > 0.0) {
-        max_possible_densiy = this->EOS->get_rho_from_P(pow(8.*M_PI*this->beta*this->gamma, 1./(1.-this->gamma)));
         this->rho_0 = max_possible_densiy - 1e-8;
-        this->evaluate_model();
-        if (this->get_quantity(quantity_label) < wanted_mass) { // in this case, the bisection will automatically not be able to converge
+        if (evaluate() < wanted_mass) { // in this case, the bisection will automatically not be able to converge
             //std::cout << "failsave activated in NSEinsteinCartan::shooting_constant_Mass" << std::endl;
             this->rho_0 = 0.0;
-            this->evaluate_model(); // set to zero
+            evaluate(); // set to zero
             return;
         }
     }
@@ -163,9 +349,8 @@ void NSEinsteinCartan::shooting_constant_Mass(double wanted_mass, std::string qu
     int i = 0;
     while (i<max_steps) {
         i++;
-        this->evaluate_model();
         // obtain the current mass
-        my_MT = this->get_quantity(quantity_label);
+        my_MT = evaluate();
         // check if obtained mass is above the wanted mass
         // if yes, we perform a bisection search in the range [0, rho_0_init]
         // if no, we increase rho_0_init by an amount and perform the above steps again
@@ -193,8 +378,7 @@ void NSEinsteinCartan::shooting_constant_Mass(double wanted_mass, std::string qu
 
     this->rho_0 = rho_c_0;
 
-    this->evaluate_model();
-    mymass_0 = this->get_quantity(quantity_label);
+    mymass_0 = evaluate();
 
     i = 0;
     // continue bisection until the wanted accuracy was reached
@@ -202,9 +386,8 @@ void NSEinsteinCartan::shooting_constant_Mass(double wanted_mass, std::string qu
         i++;
         rho_c_mid = (rho_c_0 + rho_c_1) / 2.;
         this->rho_0 = rho_c_mid;
-        this->evaluate_model();
         // obtain the current mass
-        mymass_mid = this->get_quantity(quantity_label);
+        mymass_mid = evaluate();
 
         if (mymass_mid < wanted_mass) {
             // the mid point is below the wanted ratio and we can adjust the lower bound
@@ -222,6 +405,58 @@ void NSEinsteinCartan::shooting_constant_Mass(double wanted_mass, std::string qu
     // the now obtained rho0 value is now optimized for the wanted gravitational mass and we can quit the function
 }
 
+/* The range around the guess is doubled and moved towards the wanted mass until the mass increases through it, i.e. the range is on the
+ *  stable branch below the maximum mass. Then Brent's method (see utilities::brent_zeroin) finds the root of M(rho_0) - wanted_mass in the range:
+ *  It takes secant or inverse quadratic interpolation steps through the last values when they shrink the range fast enough,
+ *  and bisection steps otherwise, until the mass is within accuracy/2 of the wanted mass
+ * */
+void NSEinsteinCartan::shooting_constant_Mass_warm_start(double wanted_mass, std::string quantity_label, double rho_0_guess, double rel_width, double accuracy, int max_steps) {
+
+    if (!( (quantity_label == "M_T") || (quantity_label == "M_rest") )) { std::cout << "Error: only searches for 'M_T' and 'M_rest' are implemented. quitting function" << std::endl; return;}
+    double NSEinsteinCartan::* const mass = (quantity_label == "M_T") ? &NSEinsteinCartan::M_T : &NSEinsteinCartan::M_rest;
+    Workspace& workspace = Workspace::thread_local_instance();
+    this->shooting_iterations = 0;
+    auto mass_difference = [&] (double rho_0) {
+        this->rho_0 = rho_0;
+        this->evaluate_model(workspace);
+        this->shooting_iterations++;
+        return this->*mass - wanted_mass;
+    };
+
+    const double rho_0_max = this->max_possible_density() - 1e-8;
+    const int max_moves = 20;
+    double width = std::min(rel_width, 0.5);
+    double a = rho_0_guess*(1. - width), b = std::min(rho_0_guess*(1. + width), rho_0_max);
+    double f_a = mass_difference(a), f_b = a < b ? mass_difference(b) : f_a;
+
+    int moves = 0;
+    while (!(f_a < 0. && f_b >= 0.)) {
+        if (moves++ == max_moves || (b >= rho_0_max && f_b < 0. && f_b >= f_a)) {  // start over, the failsafe for unattainable masses is in there
+            const int iterations = this->shooting_iterations;
+            this->rho_0 = rho_0_guess;
+            this->shooting_constant_Mass(wanted_mass, quantity_label, accuracy, max_steps);
+            this->shooting_iterations += iterations;
+            return;
+        }
+        width *= 2.;
+        if (f_b < 0. && f_b >= f_a) {   // the mass is too low and increasing, the range moves up
+            a = b; f_a = f_b;
+            b = std::min(b*(1. + width), rho_0_max);
+            f_b = mass_difference(b);
+        }
+        else {  // the mass is too high, or decreasing behind the maximum mass, the range moves down
+            b = a; f_b = f_a;
+            a = a/(1. + width);
+            f_a = mass_difference(a);
+        }
+    }
+
+    utilities::brent_zeroin(mass_difference, a, b, f_a, f_b, 2.*std::numeric_limits<double>::epsilon(), 0.5*accuracy, max_steps);
+
+    if (this->rho_0 != b)  // the star was last evaluated at the other end of the range
+        mass_difference(b);
+}
+
 std::ostream& FBS::operator<<(std::ostream &os, const NSEinsteinCartan &fbs) {
 
     return os << fbs.M_T << " "					// total gravitational mass in [M_sun]
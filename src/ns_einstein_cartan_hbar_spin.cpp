@@ -42,9 +42,10 @@ vector NSEinsteinCartanHbarSpin::dy_dr(const double r, const vector &vars, const
         P_prev=0;
     }
     else {
-        etot = myEOS.get_e_from_P(P);
-        rho = myEOS.get_rho_from_P(P);
-        dP_drho = rho > myEOS.min_rho() ? myEOS.dP_drho(rho,0.) : 0.;
+        const EoSQuantities eos = myEOS.query(P);
+        etot = eos.e;
+        rho = eos.rho;
+        dP_drho = rho > myEOS.min_rho() ? eos.dP_drho : 0.;
         drho_dP = dP_drho > 0. ? 1./dP_drho : 0.; // valid for barotropic EOS
         // previous timestep:
         rho_prev = myEOS.get_rho_from_P(P_prev);
@@ -150,8 +151,13 @@ void NSEinsteinCartanHbarSpin::evaluate_model(std::vector<integrator::step> &res
     if (!filename.empty())
     {
 		// add two columns for the energy density and restmass density to the results array:
+		std::vector<double> P(results.size()), e(results.size()), rho(results.size());
+		for(unsigned i=0; i< results.size(); i++)
+			P[i] = results[i].second[2];
+		this->EOS->e_from_P_batch(P.data(), e.data(), results.size());
+		this->EOS->rho_from_P_batch(P.data(), rho.data(), results.size());
 		for(unsigned i=0; i< results.size(); i++) {
-			results[i].second = vector({results[i].second[0], results[i].second[1], results[i].second[2], this->EOS->get_e_from_P(results[i].second[2]), this->EOS->get_rho_from_P(results[i].second[2])});
+			results[i].second = vector({results[i].second[0], results[i].second[1], results[i].second[2], e[i], rho[i]});
 		}
         plotting::save_integration_data(results, {0, 1, 2, 3, 4}, {"nu", "lambda", "P", "e", "rho"}, filename);
     }
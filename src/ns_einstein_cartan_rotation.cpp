@@ -19,21 +19,28 @@ vector NSEinsteinCartanRotation::get_initial_conditions(const double r_init) con
 }
 
 vector NSEinsteinCartanRotation::dy_dr(const double r, const vector &vars) const {
+    return this->dy_dr(r, fixed_vector<3>(vars)).to_vector();
+}
+
+fixed_vector<3> NSEinsteinCartanRotation::dy_dr(const double r, const fixed_vector<3> &vars) const {
+    return this->dy_dr(r, vars, *(this->EOS));
+}
+
+template <typename E>
+fixed_vector<3> NSEinsteinCartanRotation::dy_dr(const double r, const fixed_vector<3> &vars, E& myEOS) const {
 
 	// rename variables for convenience
     const double a = vars[0], alpha = vars[1]; double P = vars[2];
 
-    // load the EOS for the NS fluid:
-    EquationOfState &myEOS = *(this->EOS);
-
     // call the EOS and compute the wanted values:
     double etot=0., dP_de =0., de_dP =0.;	// total energy density of the fluid
     if (P <= 0. || P < myEOS.min_P()) {
         P = 0.;
     }
     else {
-        etot = myEOS.get_e_from_P(P);
-		dP_de = etot > myEOS.min_e() ? myEOS.dP_de(etot) : 0.;
+        const EoSQuantities eos = myEOS.query(P);
+        etot = eos.e;
+		dP_de = etot > myEOS.min_e() ? eos.dP_de : 0.;
         de_dP = dP_de > 0. ? 1./dP_de : 0.;
     }
 
@@ -52,94 +59,85 @@ vector NSEinsteinCartanRotation::dy_dr(const double r, const vector &vars) const
 	//double dP_dr = ( ( 32.*M_PI*s2 *(1./r + r*this->Omega_rot*this->Omega_rot* Gamma*Gamma) ) - (etot + P - 16.*M_PI*s2) * dalpha_dr/alpha ) / division_term; // fully consistent model
     double dP_dr = - (etot + P - 16.*M_PI*s2) * dalpha_dr/alpha  / division_term;   // approximate model
 
-    return vector({da_dr, dalpha_dr, dP_dr});
+    return fixed_vector<3>({da_dr, dalpha_dr, dP_dr});
 }
 
+int NSEinsteinCartanRotation::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    return dispatch_eos(*(this->EOS), [&](auto& myEOS) {
+        const auto rhs = [this, &myEOS](const double r, const fixed_vector<3>& y, const void*) { return this->dy_dr(r, y, myEOS); };
+        return this->integrate_fixed<3>(rhs, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+    });
+}
+
+/* Integrates the star without saving the steps, the star parameters are computed during the integration */
 void NSEinsteinCartanRotation::evaluate_model() {
 
-    std::vector<integrator::step> results;
-    this->evaluate_model(results);
+    Workspace workspace;
+    this->evaluate_model(workspace);
+}
+
+void NSEinsteinCartanRotation::evaluate_model(Workspace& workspace) {
+
+    integrator::IntegrationOptions intOpts;
+    std::vector<integrator::Event>& events = workspace.events();
+    events.push_back(Pressure_zero); events.push_back(Pressure_diverging); events.push_back(P_min_reached);
+    integrator::Trajectory& results = workspace.trajectory(0);
+    NSEinsteinCartanObserver observer(this->EOS, &workspace.array(0, 0));
+
+    this->integrate(results, events, this->get_initial_conditions(), intOpts, -1., -1., &observer);
+    observer.finalize();
+    this->set_star_parameters(observer);
 }
 
-void NSEinsteinCartanRotation::evaluate_model(std::vector<integrator::step> &results, std::string filename) {
+void NSEinsteinCartanRotation::evaluate_model(integrator::Trajectory &results, std::string filename) {
 
     // define variables used in the integrator and events during integration:
     integrator::IntegrationOptions intOpts;
     intOpts.save_intermediate = true;
-    intOpts.max_stepsize = 1e-3;
-    // stop integration if pressure is zero:
-    std::vector<integrator::Event> events = {Pressure_zero, Pressure_diverging};
+    // stop integration if pressure is zero, the radius is located by P_min_reached:
+    std::vector<integrator::Event> events = {Pressure_zero, Pressure_diverging, P_min_reached};
     results.clear();
 
     this->integrate(results, events, this->get_initial_conditions(), intOpts); // integrate the star
 
+    NSEinsteinCartanRotation::calculate_star_parameters(results, events);
+
     // option to save all the radial profiles into a txt file:
     if (!filename.empty())
     {
-		// add two columns for the energy density and restmass density to the results array:
-		for(unsigned i=0; i< results.size(); i++) {
-			results[i].second = vector({results[i].second[0], results[i].second[1], results[i].second[2], this->EOS->get_e_from_P(results[i].second[2]), this->EOS->get_rho_from_P(results[i].second[2])});
-		}
+		// add two columns for the energy density and restmass density to the results:
+		const std::vector<double>& P = results.column(2);
+		std::vector<double> e(results.size()), rho(results.size());
+		this->EOS->e_from_P_batch(P.data(), e.data(), results.size());
+		this->EOS->rho_from_P_batch(P.data(), rho.data(), results.size());
+		results.add_column(e);
+		results.add_column(rho);
         plotting::save_integration_data(results, {0, 1, 2, 3, 4}, {"a", "alpha", "P", "e", "rho"}, filename);
     }
-
-    NSEinsteinCartanRotation::calculate_star_parameters(results, events);
 }
 
 
-void NSEinsteinCartanRotation::calculate_star_parameters(const std::vector<integrator::step> &results, const std::vector<integrator::Event> &events) {
+/* The star parameters are computed in the same way as in NSEinsteinCartan, but saved in the members of this class */
+void NSEinsteinCartanRotation::calculate_star_parameters(const integrator::Trajectory &results, const std::vector<integrator::Event> &events) {
 
-    // compute all values of the star, including mass and radius:
-    int last_index = results.size() - 1; // last index in the integration
-
-	// we stop the integration when the pressure reaches zero. This corresponds to the radius of the NS.
-	// we extract the total gravitational mass M_T also at this point (outside of the NS is just Schwarzschild):
-	//R_NS = results[last_index].first;
-	for (unsigned i = 1; i < results.size(); i++) {
-        if (results[i].second[2] < P_ns_min || results[i].second[2] < this->EOS->min_P()) {
-            R_NS = results[i].first; // radius uf NS
-            break;
-        }
-    }
-	M_T = results[last_index].first / 2. * (1. - 1./pow(results[last_index].second[0], 2));	// M = R/2 * (1 - 1/ a(R)^2 )
-	double C = M_T / R_NS; // compactness of the NS
-
-	// compute the total restmass of the NS using the conserved Noether current (conservation of fluid flow: J^mu = rho u^mu)
-    std::vector<double> r(results.size()), N_F_integrand(results.size());
-    vector v;
-    double rho, eps;
-	// compute restmass at each r:
-    for(unsigned int i = 0; i < results.size(); i++) {
-        r[i] = results[i].first;
-        v = results[i].second;
-        // P = v[2]
-        if (v[2] < P_ns_min || v[2] < this->EOS->min_P()) {rho = 0.;}
-        else {this->EOS->callEOS(rho, eps, v[2]);}
-        N_F_integrand[i] = 4.*M_PI * v[0] * rho * r[i] * r[i];
-	}
-    // integrate:
-    std::vector<double> N_F_integrated;
-    integrator::cumtrapz(r, N_F_integrand, N_F_integrated);
-    // compute the restmass density:
-    double N_F =  N_F_integrated[last_index];
-
-    // compute radius where 99% of the restmass is contained:
-	// find index where this happens
-	int i_F = 0;
-    for(int i = 1; i < last_index; i++) {
-        if(N_F_integrated[i] < 0.99*N_F) {i_F++;}       
-    }
-    // obtain radius from corresponding index:
-    double R_99 = results[i_F].first;
-
-    // ---------------------------------------------------------------------------------
+    NSEinsteinCartanObserver observer(this->EOS);
+    const std::vector<double>& a = results.column(0), &P = results.column(2);
+    std::vector<double> rho(results.size()), eps(results.size());
+    this->EOS->callEOS_batch(P.data(), rho.data(), eps.data(), results.size());
+    for (unsigned i = 0; i < results.size(); i++)
+        observer.observe(results.r(i), a[i], P[i], rho[i]);
+    observer.finalize();
+    this->set_star_parameters(observer);
+}
 
+void NSEinsteinCartanRotation::set_star_parameters(const NSEinsteinCartanObserver& observer) {
     // update all the global star values:
-    this->M_T = M_T;	// total gravitational mass
-    this->R_99 = R_99;	// radius where 99% of restmass is contained (also calles 'tidal radius')
-    this->R_NS = R_NS;	// radius of NS
-    this->C = C;		// compactness
-    this->M_rest = N_F;	// total restmass
+    this->M_T = observer.M_T;	// total gravitational mass
+    this->R_99 = observer.R_99;	// radius where 99% of restmass is contained (also calles 'tidal radius')
+    if (observer.surface_found)
+        this->R_NS = observer.R_NS;	// radius of NS
+    this->C = this->M_T / this->R_NS;		// compactness of the NS
+    this->M_rest = observer.M_rest;	// total restmass
 }
 
 
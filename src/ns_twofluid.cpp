@@ -15,15 +15,20 @@ vector NSTwoFluid::get_initial_conditions(const double r_init) const {
 }
 
 vector NSTwoFluid::dy_dr(const double r, const vector &vars) const {
+    return this->dy_dr(r, fixed_vector<6>(vars)).to_vector();
+}
+
+fixed_vector<6> NSTwoFluid::dy_dr(const double r, const fixed_vector<6> &vars) const {
+    return this->dy_dr(r, vars, *(this->EOS), *(this->EOS_fluid2));
+}
+
+template <typename E1, typename E2>
+fixed_vector<6> NSTwoFluid::dy_dr(const double r, const fixed_vector<6> &vars, E1& myEOS1, E2& myEOS2) const {
 
     const double /*nu = vars[0],*/ m1 = vars[1], m2 = vars[2];
     double P1 = vars[3], P2 = vars[4];
     const double Y = vars[5];
 
-    // load the EoS from both fluids:
-    EquationOfState &myEOS1 = *(this->EOS);
-    EquationOfState &myEOS2 = *(this->EOS_fluid2);
-
     // call both EoS and compute the wanted values
     double etot1=0., dP1_detot=0., detot_dP1=0.;
     double etot2=0., dP2_detot=0., detot_dP2=0.;
@@ -35,8 +40,9 @@ vector NSTwoFluid::dy_dr(const double r, const vector &vars) const {
     }
     else
     {
-        etot1 = myEOS1.get_e_from_P(P1);
-        dP1_detot = etot1 > myEOS1.min_e() ? myEOS1.dP_de(etot1) : 0.;
+        const EoSQuantities eos1 = myEOS1.query(P1);
+        etot1 = eos1.e;
+        dP1_detot = etot1 > myEOS1.min_e() ? eos1.dP_de : 0.;
         detot_dP1 = dP1_detot > 0. ? 1. / dP1_detot : 0.;
     }
     // second EoS
@@ -47,8 +53,9 @@ vector NSTwoFluid::dy_dr(const double r, const vector &vars) const {
     }
     else
     {
-        etot2 = myEOS2.get_e_from_P(P2);
-        dP2_detot = etot2 > myEOS2.min_e() ? myEOS2.dP_de(etot2) : 0.;
+        const EoSQuantities eos2 = myEOS2.query(P2);
+        etot2 = eos2.e;
+        dP2_detot = etot2 > myEOS2.min_e() ? eos2.dP_de : 0.;
         detot_dP2 = dP2_detot > 0. ? 1. / dP2_detot : 0.;
     }
 
@@ -69,11 +76,20 @@ vector NSTwoFluid::dy_dr(const double r, const vector &vars) const {
     double Q = 4. * M_PI * e_lambda * (5. * (etot_tot) + 9. * (P1 + P2) + rhoP_param) - 6. * e_lambda / r / r - dnu_dr * dnu_dr; // helper variable Q
     double dY_dr = -Y * Y / r - Y * e_lambda * (1. + 4. * M_PI * r * r * (Ptot - etot_tot)) / r - r * Q;								// tidal perturbation function y(r)
 
-    return vector({dnu_dr, dm1_dr, dm2_dr, dP1_dr, dP2_dr, dY_dr});
+    return fixed_vector<6>({dnu_dr, dm1_dr, dm2_dr, dP1_dr, dP2_dr, dY_dr});
+}
+
+int NSTwoFluid::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    return dispatch_eos(*(this->EOS), [&](auto& myEOS1) {
+        return dispatch_eos(*(this->EOS_fluid2), [&](auto& myEOS2) {
+            const auto rhs = [this, &myEOS1, &myEOS2](const double r, const fixed_vector<6>& y, const void*) { return this->dy_dr(r, y, myEOS1, myEOS2); };
+            return this->integrate_fixed<6>(rhs, result, events, initial_conditions, intOpts, r_init, r_end, observer);
+        });
+    });
 }
 
 
-void NSTwoFluid::calculate_star_parameters(const std::vector<integrator::step> &results, const std::vector<integrator::Event> &events) {
+void NSTwoFluid::calculate_star_parameters(const integrator::Trajectory &results, const std::vector<integrator::Event> &events, Workspace* workspace) {
 
     // compute all values of the star, including the tidal deformability:
 
@@ -81,29 +97,29 @@ void NSTwoFluid::calculate_star_parameters(const std::vector<integrator::step> &
 
     // next compute the masses of only 1st fluid and 2nd fluid respectively:
     // it is fine to take the last indices of the whole integration because once one fluid has reached zero pressure, the change in mass dm/dr will be zero
-    double M_1 = results[last_index].second[1];
-    double M_2 = results[last_index].second[2];
+    double M_1 = results.y(last_index, 1);
+    double M_2 = results.y(last_index, 2);
 
     // compute the radii of 1st and 2nd fluid:
     // radius where pressure is approximately zero:
     int i_R1_0 = last_index, i_R2_0 = last_index;
-    double R_1_0 = results[last_index].first, R_2_0 = results[last_index].first;
+    double R_1_0 = results.r(last_index), R_2_0 = results.r(last_index);
     // there is an edgecase where the pressure does not drop below P_ns_min within the largest allowed integration radius R_MAX (=500).
     // in this case the below iteration will return the initialization value for R_1_0, i_R1_0 etc.
     for (unsigned i = 1; i < results.size(); i++)
     {
-        if (results[i].second[3] < P_ns_min || results[i].second[3] < this->EOS->min_P())
+        if (results.y(i, 3) < P_ns_min || results.y(i, 3) < this->EOS->min_P())
         {
-            R_1_0 = results[i].first; // 1st fluid
+            R_1_0 = results.r(i); // 1st fluid
             i_R1_0 = i;
             break;
         }
     }
     for (unsigned i = 1; i < results.size(); i++)
     {
-        if (results[i].second[4] < P_ns_min || results[i].second[4] < this->EOS_fluid2->min_P())
+        if (results.y(i, 4) < P_ns_min || results.y(i, 4) < this->EOS_fluid2->min_P())
         {
-            R_2_0 = results[i].first; // 2nd fluid
+            R_2_0 = results.r(i); // 2nd fluid
             i_R2_0 = i;
             break;
         }
@@ -117,24 +133,25 @@ void NSTwoFluid::calculate_star_parameters(const std::vector<integrator::step> &
     int i_R_1 = 0, i_R_2 = 0;
     for (unsigned int i = 0; i < results.size(); i++)
     {
-        if (results[i].second[1] < 0.99 * M_1)
+        if (results.y(i, 1) < 0.99 * M_1)
             i_R_1++;
-        if (results[i].second[2] < 0.99 * M_2)
+        if (results.y(i, 2) < 0.99 * M_2)
             i_R_2++;
     }
     // obtain radius from corresponding index
-    double R_1 = results[i_R_1].first, R_2 = results[i_R_2].first;
+    double R_1 = results.r(i_R_1), R_2 = results.r(i_R_2);
 
     // compute the fermion/boson number using the conserved Noether current
     /*  N_B, N_F i.e. N_1 and N_2
      *  We need to integrate the particle number densities to obtain N_B, N_F */
-    std::vector<double> r(results.size()), N_B_integrand(results.size()), N_F_integrand(results.size());
-    vector v;
+    const std::vector<double>& r = results.r();
+    Workspace local_workspace;
+    Workspace& ws = workspace ? *workspace : local_workspace;
+    std::vector<double>& N_B_integrand = ws.array(0, results.size()), &N_F_integrand = ws.array(1, results.size());
     double rho, eps;
 
     for(unsigned int i = 0; i < results.size(); i++) {
-        r[i] = results[i].first;
-        v = results[i].second;
+        const integrator::StepView v = results[i];
         // calc values for 1st fluid: P1 = v[3]
         if (v[3] < P_ns_min || v[3] < this->EOS->min_P()) {rho = 0.;}
         else {this->EOS->callEOS(rho, eps, v[3]);}
@@ -149,7 +166,7 @@ void NSTwoFluid::calculate_star_parameters(const std::vector<integrator::step> &
     }
 
     // Integrate
-    std::vector<double> N_F_integrated, N_B_integrated;
+    std::vector<double>& N_F_integrated = ws.array(2, results.size()), &N_B_integrated = ws.array(3, results.size());
     integrator::cumtrapz(r, N_F_integrand, N_F_integrated);
     integrator::cumtrapz(r, N_B_integrand, N_B_integrated);
 
@@ -164,7 +181,7 @@ void NSTwoFluid::calculate_star_parameters(const std::vector<integrator::step> &
     double C = M_T / maxR; // compactness of conbined configuration
     // otain the value of y(r) at maxR:
     int maxRindex = std::max(i_R1_0, i_R2_0);
-    double y_R = results[maxRindex].second[5];
+    double y_R = results.y(maxRindex, 5);
     //std::cout << y_R << " " << C << std::endl;
 
     // compute tidal love number k2:
@@ -193,17 +210,23 @@ void NSTwoFluid::calculate_star_parameters(const std::vector<integrator::step> &
 
 void NSTwoFluid::evaluate_model() {
 
-    std::vector<integrator::step> results;
-    this->evaluate_model(results);
+    Workspace workspace;
+    this->evaluate_model(workspace);
+}
+
+void NSTwoFluid::evaluate_model(Workspace& workspace) {
+    this->evaluate_model(workspace.trajectory(0), "", &workspace);
 }
 
-void NSTwoFluid::evaluate_model(std::vector<integrator::step> &results, std::string filename) {
+void NSTwoFluid::evaluate_model(integrator::Trajectory &results, std::string filename, Workspace* workspace) {
 
     // define variables used in the integrator and events during integration:
     integrator::IntegrationOptions intOpts;
     intOpts.save_intermediate = true;
     // stop integration if pressure is zero for both fluids:
-    std::vector<integrator::Event> events = {NSTwoFluid::all_Pressure_zero};
+    Workspace local_workspace;
+    std::vector<integrator::Event>& events = (workspace ? *workspace : local_workspace).events();
+    events.push_back(NSTwoFluid::all_Pressure_zero);
     results.clear();
 
     this->integrate(results, events, this->get_initial_conditions(), intOpts); // integrate the star
@@ -215,7 +238,7 @@ void NSTwoFluid::evaluate_model(std::vector<integrator::step> &results, std::str
         plotting::save_integration_data(results, {0, 1, 2, 3, 4, 5}, {"nu", "m1", "m2", "P1", "P2", "y(r)"}, filename);
     }
 
-    this->calculate_star_parameters(results, events);
+    this->calculate_star_parameters(results, events, workspace);
 }
 
 std::ostream& FBS::operator<<(std::ostream &os, const NSTwoFluid &fbs) {
@@ -17,10 +17,11 @@ vector NSmodel::dy_dr_static(const double r, const vector& y, const void* params
  * The initial conditions have to be specified - usually given by NSmodel::get_initial_conditions - but they can be modified
  * The IntegrationOptions will be passed to the integrator
  * The integration starts at r_init and tries to reach r_end
+ * The observer, if given, is called on every step of the integration
  * The return value is the one given by the integrator, compare integrator::return_reason
  * */
-int NSmodel::integrate(std::vector<integrator::step>& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end) const {
-    return FBS::integrator::RKF45(&(this->dy_dr_static), (r_init < 0. ? this->r_init : r_init), initial_conditions, (r_end < 0. ? this->r_end : r_end), (void*) this,  result,  events, intOpts);
+int NSmodel::integrate(integrator::Trajectory& result, std::vector<integrator::Event>& events, const vector initial_conditions, integrator::IntegrationOptions intOpts, double r_init, double r_end, integrator::Observer* observer) const {
+    return FBS::integrator::RKF45(&(this->dy_dr_static), (r_init < 0. ? this->r_init : r_init), initial_conditions, (r_end < 0. ? this->r_end : r_end), (void*) this,  result,  events, intOpts, observer);
 }
 
 /* same functions as above but for NSmodelv2: */
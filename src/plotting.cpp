@@ -6,24 +6,19 @@ using namespace FBS;
 namespace plt = matplotlibcpp;
 #endif
 
-void plotting::plot_evolution(const std::vector<integrator::step>& results, const std::vector<integrator::Event>& events, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename, bool plot_abs) {
+void plotting::plot_evolution(const integrator::Trajectory& results, const std::vector<integrator::Event>& events, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename, bool plot_abs) {
     assert(results.size() > 0);
     assert(plot_components.size() == labels.size());
 #ifdef DEBUG_PLOTTING
-    std::vector<double> r;
-    r.reserve(results.size());
-    for(auto it = results.begin(); it != results.end(); ++it)
-        r.push_back(it->first);
-
     for(unsigned int i = 0; i < plot_components.size(); i++) {
-        std::vector<double> y;
-        y.reserve(results.size());
         int index = plot_components[i];
-        assert(index >= 0 && index < results[0].second.size());
-        for(auto it = results.begin(); it != results.end(); ++it) {
-            y.push_back(plot_abs ? std::abs(it->second[index]) : it->second[index] );
+        assert(index >= 0 && index < (int)results.dim());
+        std::vector<double> y = results.column(index);
+        if(plot_abs) {
+            for(auto it = y.begin(); it != y.end(); ++it)
+                *it = std::abs(*it);
         }
-        plt::plot(r, y, {{"label", labels[i]}});
+        plt::plot(results.r(), y, {{"label", labels[i]}});
     }
     if(!filename.empty())
         plt::save(filename);
@@ -34,6 +29,29 @@ void plotting::plot_evolution(const std::vector<integrator::step>& results, cons
 #endif
 }
 
+void plotting::save_integration_data(const integrator::Trajectory& results, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename) {
+
+    std::ofstream img;
+    if(filename.empty())
+        return;
+    img.open(filename);
+
+    if(img.is_open()) {
+        img << "# r";
+        for(unsigned int i = 0; i < plot_components.size(); i++)
+            img << "\t" << labels[i];
+        img << std::endl;
+
+        for(unsigned int j = 0; j < results.size(); j++) {
+            img << std::fixed << std::setprecision(10) << results.r(j);    // radius
+            for(unsigned int i = 0; i < plot_components.size(); i++)
+                img << std::scientific << std::setprecision(10) <<  " " << results.y(j, plot_components[i]); // the other variables
+            img << std::endl;
+        }
+    }
+    img.close();
+}
+
 void plotting::save_integration_data(const std::vector<integrator::step>& results, std::vector<int> plot_components, std::vector<std::string> labels, std::string filename) {
 
     std::ofstream img;
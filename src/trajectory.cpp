@@ -0,0 +1,56 @@
+#include "trajectory.hpp"
+
+using namespace FBS;
+
+void integrator::Trajectory::clear() {
+    radii.clear();
+    for(auto it = columns.begin(); it != columns.end(); ++it)
+        it->clear();
+}
+
+void integrator::Trajectory::reserve(std::size_t n) {
+    radii.reserve(n);
+    for(auto it = columns.begin(); it != columns.end(); ++it)
+        it->reserve(n);
+}
+
+std::size_t integrator::Trajectory::memory() const {
+    std::size_t n = radii.capacity();
+    for(auto it = columns.begin(); it != columns.end(); ++it)
+        n += it->capacity();
+    return n * sizeof(double);
+}
+
+void integrator::Trajectory::truncate(std::size_t n) {
+    if(n >= this->size())
+        return;
+    radii.resize(n);
+    for(auto it = columns.begin(); it != columns.end(); ++it)
+        it->resize(n);
+}
+
+void integrator::Trajectory::append(const Trajectory& other, std::size_t begin) {
+    if(begin >= other.size())
+        return;
+    if(this->empty() && columns.size() != other.dim())
+        columns.resize(other.dim());
+    if(columns.size() != other.dim())
+        throw std::runtime_error("Trajectory: dimension mismatch");
+
+    radii.insert(radii.end(), other.radii.begin() + begin, other.radii.end());
+    for(unsigned int k = 0; k < columns.size(); k++)
+        columns[k].insert(columns[k].end(), other.columns[k].begin() + begin, other.columns[k].end());
+}
+
+void integrator::Trajectory::add_column(std::vector<double> values) {
+    if(values.size() != this->size())
+        throw std::runtime_error("Trajectory: column size mismatch");
+    columns.push_back(std::move(values));
+}
+
+vector integrator::Trajectory::y(std::size_t i) const {
+    vector v(columns.size());
+    for(unsigned int k = 0; k < columns.size(); k++)
+        v[k] = columns[k][i];
+    return v;
+}
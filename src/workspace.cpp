@@ -0,0 +1,96 @@
+#include "workspace.hpp"
+
+using namespace FBS;
+
+integrator::Trajectory& Workspace::trajectory(unsigned int slot) {
+    while(trajectories.size() <= slot)
+        trajectories.emplace_back(new integrator::Trajectory());
+    integrator::Trajectory& t = *trajectories[slot];
+    max_steps = std::max(max_steps, t.size());    // the previous use of this slot is finished
+    t.clear();
+    uses++;
+    return t;
+}
+
+std::vector<double>& Workspace::array(unsigned int slot, std::size_t n) {
+    while(arrays.size() <= slot)
+        arrays.emplace_back(new std::vector<double>());
+    std::vector<double>& a = *arrays[slot];
+    a.resize(n);
+    max_array_size = std::max(max_array_size, n);
+    return a;
+}
+
+std::vector<integrator::Event>& Workspace::events() {
+    event_list.clear();
+    return event_list;
+}
+
+Workspace::Statistics Workspace::statistics() const {
+    Statistics stats;
+    stats.uses = uses;
+    stats.max_steps = max_steps;
+    stats.max_array_size = max_array_size;
+    for(auto it = trajectories.begin(); it != trajectories.end(); ++it) {
+        stats.max_steps = std::max(stats.max_steps, (*it)->size());
+        stats.memory += (*it)->memory();
+    }
+    for(auto it = arrays.begin(); it != arrays.end(); ++it)
+        stats.memory += (*it)->capacity() * sizeof(double);
+    stats.workspaces = 1;
+    return stats;
+}
+
+/* The thread-local workspaces register themselves, so that their statistics can be combined.
+ * When a thread finishes, the statistics of its workspace are kept in retired_statistics */
+namespace {
+
+std::mutex registry_mutex;
+std::vector<const Workspace*> registry;
+Workspace::Statistics retired_statistics;
+
+void combine(Workspace::Statistics& total, const Workspace::Statistics& stats) {
+    total.uses += stats.uses;
+    total.max_steps = std::max(total.max_steps, stats.max_steps);
+    total.max_array_size = std::max(total.max_array_size, stats.max_array_size);
+    total.memory += stats.memory;
+    total.workspaces += stats.workspaces;
+}
+
+class RegisteredWorkspace : public Workspace {
+public:
+    RegisteredWorkspace() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(this);
+    }
+    ~RegisteredWorkspace() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        Workspace::Statistics stats = this->statistics();
+        stats.memory = 0;   // the memory is freed with the thread
+        combine(retired_statistics, stats);
+        registry.erase(std::find(registry.begin(), registry.end(), this));
+    }
+};
+
+}
+
+Workspace& Workspace::thread_local_instance() {
+    thread_local RegisteredWorkspace workspace;
+    return workspace;
+}
+
+Workspace::Statistics Workspace::total_statistics() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    Statistics total = retired_statistics;
+    for(auto it = registry.begin(); it != registry.end(); ++it)
+        combine(total, (*it)->statistics());
+    return total;
+}
+
+std::ostream& FBS::operator <<(std::ostream& os, const Workspace::Statistics& stats) {
+    return os   << "workspaces: " << stats.workspaces
+                << ", trajectories used: " << stats.uses
+                << ", max steps: " << stats.max_steps
+                << ", max array size: " << stats.max_array_size
+                << ", memory: " << stats.memory/1024. << " kB";
+}